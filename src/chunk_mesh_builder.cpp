@@ -0,0 +1,660 @@
+#include "chunk_mesh_builder.h"
+#include "math_utils.h"
+#include "scratch_arena.h"
+#include "trace.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+void computeSplatWeights(
+    const Heightfield& heightfield,
+    const ChunkMeshSettings& settings,
+    const NoiseGenerator* biomeNoise,
+    ChunkMeshData& out)
+{
+    TRACE_ZONE("splat weights");
+
+    const SplatSettings& s = settings.splat;
+    const i32 verts_per_side = heightfield.layout.vertsPerSide;
+    const f32 water = static_cast<f32>(settings.waterLevel);
+    const bool use_biome = biomeNoise != nullptr && s.biome_frequency > 0.0f;
+
+    const f64 quad_size = settings.tileWidth * static_cast<f64>(heightfield.layout.step);
+    const f64 chunk_world_x0 = static_cast<f64>(heightfield.coord.x) * static_cast<f64>(settings.chunkSize) * settings.tileWidth;
+    const f64 chunk_world_z0 = static_cast<f64>(heightfield.coord.z) * static_cast<f64>(settings.chunkSize) * settings.tileWidth;
+
+    const size_t vertex_count = out.vertexCount();
+    out.weights.resize(vertex_count * 4);
+
+    for (size_t i = 0; i < vertex_count; i++) {
+        const i32 g = out.gridIndices[i];
+        const f32 sample = heightfield.samples[g];
+        const f32 slope = 1.0f - out.normals[i * 3 + 1];
+
+        const f32 rock = smoothstep(s.rock_slope - s.blend, s.rock_slope + s.blend, slope);
+        const f32 snow = smoothstep(s.snow_height - s.blend, s.snow_height + s.blend, sample) * (1.0f - rock);
+        const f32 sand_line = water + s.sand_height;
+        f32 sand = (1.0f - smoothstep(sand_line - s.blend, sand_line + s.blend, sample)) * (1.0f - rock) * (1.0f - snow);
+        f32 grass = std::max(0.0f, 1.0f - rock - snow - sand);
+
+        if (use_biome) {
+            const f64 world_x = chunk_world_x0 + static_cast<f64>(g % verts_per_side) * quad_size;
+            const f64 world_z = chunk_world_z0 + static_cast<f64>(g / verts_per_side) * quad_size;
+            const f32 dryness = smoothstep(0.55f, 0.75f, static_cast<f32>(biomeNoise->getNoiseValue(world_x, world_z)));
+            sand += grass * dryness;
+            grass *= (1.0f - dryness);
+        }
+
+        const f32 total = grass + rock + sand + snow;
+        const f32 scale = total > 0.0f ? 255.0f / total : 0.0f;
+
+        u8* w = &out.weights[i * 4];
+        w[0] = static_cast<u8>(std::lround(grass * scale));
+        w[1] = static_cast<u8>(std::lround(rock * scale));
+        w[2] = static_cast<u8>(std::lround(sand * scale));
+        w[3] = static_cast<u8>(std::lround(snow * scale));
+    }
+}
+
+// Area weighted normals of the uniform grid triangulation, per grid vertex. Face normals are taken
+// per quad first, then every vertex sums its faces in the order the quads are visited, so each
+// pass is a straight loop and the sums match a scatter over the triangles bit for bit.
+void computeGridNormals(const f32* heights, int squares_per_side, f32 quad_size, ScratchArena& arena, f32* normals)
+{
+    TRACE_ZONE("grid normals");
+
+    const int verts_per_side = squares_per_side + 1;
+    const size_t quad_count = static_cast<size_t>(squares_per_side) * squares_per_side;
+
+    const ScratchScope scratch(arena);
+    f32* ax = arena.allocate<f32>(quad_count * 6); // (v00, v11, v01)
+    f32* ay = ax + quad_count;
+    f32* az = ay + quad_count;
+    f32* bx = az + quad_count; // (v00, v10, v11)
+    f32* by = bx + quad_count;
+    f32* bz = by + quad_count;
+
+    for (int z = 0; z < squares_per_side; z++) {
+        const f32 z0 = static_cast<f32>(z) * quad_size;
+        const f32 z1 = static_cast<f32>(z + 1) * quad_size;
+        const f32* row0 = heights + static_cast<size_t>(z) * verts_per_side;
+        const f32* row1 = row0 + verts_per_side;
+        const size_t q0 = static_cast<size_t>(z) * squares_per_side;
+
+        for (int x = 0; x < squares_per_side; x++) {
+            const f32 x0 = static_cast<f32>(x) * quad_size;
+            const f32 x1 = static_cast<f32>(x + 1) * quad_size;
+            const f32 h00 = row0[x];
+            const f32 h10 = row0[x + 1];
+            const f32 h01 = row1[x];
+            const f32 h11 = row1[x + 1];
+
+            // (b - a) x (c - a), spelled out as the general form so rounding stays the same
+            {
+                const f32 abx = x1 - x0, aby = h11 - h00, abz = z1 - z0;
+                const f32 acx = x0 - x0, acy = h01 - h00, acz = z1 - z0;
+                ax[q0 + x] = aby * acz - abz * acy;
+                ay[q0 + x] = abz * acx - abx * acz;
+                az[q0 + x] = abx * acy - aby * acx;
+            }
+            {
+                const f32 abx = x1 - x0, aby = h10 - h00, abz = z0 - z0;
+                const f32 acx = x1 - x0, acy = h11 - h00, acz = z1 - z0;
+                bx[q0 + x] = aby * acz - abz * acy;
+                by[q0 + x] = abz * acx - abx * acz;
+                bz[q0 + x] = abx * acy - aby * acx;
+            }
+        }
+    }
+
+    // Quads around vertex (x, z) in visiting order: (x-1, z-1) both faces, (x, z-1) face a,
+    // (x-1, z) face b, (x, z) both faces.
+    auto gather = [&](const f32* fa, const f32* fb, int x, int z) -> f32 {
+        f32 sum = 0.0f;
+        if (z > 0) {
+            const size_t above = static_cast<size_t>(z - 1) * squares_per_side;
+            if (x > 0) {
+                sum += fa[above + x - 1];
+                sum += fb[above + x - 1];
+            }
+            if (x < squares_per_side) sum += fa[above + x];
+        }
+        if (z < squares_per_side) {
+            const size_t here = static_cast<size_t>(z) * squares_per_side;
+            if (x > 0) sum += fb[here + x - 1];
+            if (x < squares_per_side) {
+                sum += fa[here + x];
+                sum += fb[here + x];
+            }
+        }
+        return sum;
+    };
+
+    for (int z = 0; z <= squares_per_side; z++) {
+        f32* row = normals + static_cast<size_t>(z) * verts_per_side * 3;
+
+        if (z == 0 || z == squares_per_side) {
+            for (int x = 0; x <= squares_per_side; x++) {
+                row[x * 3 + 0] = gather(ax, bx, x, z);
+                row[x * 3 + 1] = gather(ay, by, x, z);
+                row[x * 3 + 2] = gather(az, bz, x, z);
+            }
+            continue;
+        }
+
+        for (const int x : { 0, squares_per_side }) {
+            row[x * 3 + 0] = gather(ax, bx, x, z);
+            row[x * 3 + 1] = gather(ay, by, x, z);
+            row[x * 3 + 2] = gather(az, bz, x, z);
+        }
+
+        // Interior vertices touch all four quads
+        const size_t above = static_cast<size_t>(z - 1) * squares_per_side;
+        const size_t here = static_cast<size_t>(z) * squares_per_side;
+        for (int x = 1; x < squares_per_side; x++) {
+            const size_t ul = above + x - 1, ur = above + x, dl = here + x - 1, dr = here + x;
+            row[x * 3 + 0] = 0.0f + ax[ul] + bx[ul] + ax[ur] + bx[dl] + ax[dr] + bx[dr];
+            row[x * 3 + 1] = 0.0f + ay[ul] + by[ul] + ay[ur] + by[dl] + ay[dr] + by[dr];
+            row[x * 3 + 2] = 0.0f + az[ul] + bz[ul] + az[ur] + bz[dl] + az[dr] + bz[dr];
+        }
+    }
+
+    const size_t normal_count = static_cast<size_t>(verts_per_side) * verts_per_side * 3;
+    for (size_t i = 0; i < normal_count; i += 3) {
+        f32* n = &normals[i];
+        const f32 len2 = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+        if (len2 > 0.000001f) {
+            const f32 inv = 1.0f / std::sqrt(len2);
+            n[0] *= inv;
+            n[1] *= inv;
+            n[2] *= inv;
+        } else {
+            n[0] = 0.0f;
+            n[1] = 1.0f;
+            n[2] = 0.0f;
+        }
+    }
+}
+
+struct QuadLeaf {
+    int x0;
+    int z0;
+    int size;
+};
+
+// Checks whether a node rendered as a fan around its centre stays within the error bound.
+// Vertices on the chunk border must be reproduced exactly.
+bool fanWithinError(const f32* heights, int verts_per_side, int x0, int z0, int size, f32 max_error, f32 border_error)
+{
+    const int last = verts_per_side - 1;
+    const int half = size / 2;
+
+    auto h = [&](int x, int z) { return heights[static_cast<size_t>(z) * verts_per_side + x]; };
+
+    const f32 h00 = h(x0, z0);
+    const f32 h10 = h(x0 + size, z0);
+    const f32 h01 = h(x0, z0 + size);
+    const f32 h11 = h(x0 + size, z0 + size);
+    const f32 hc = h(x0 + half, z0 + half);
+    const f32 inv = 1.0f / static_cast<f32>(size);
+
+    for (int z = z0; z <= z0 + size; z++) {
+        for (int x = x0; x <= x0 + size; x++) {
+            const f32 dx = static_cast<f32>(x - x0) * inv - 0.5f;
+            const f32 dz = static_cast<f32>(z - z0) * inv - 0.5f;
+
+            // Pick the fan triangle and interpolate from the centre towards the perimeter edge.
+            f32 t = 0.0f, w = 0.0f, ha = hc, hb = hc;
+            if (std::abs(dx) >= std::abs(dz)) {
+                if (dx == 0.0f) continue; // centre itself
+                t = 2.0f * std::abs(dx);
+                w = (dz / std::abs(dx) + 1.0f) * 0.5f;
+                ha = dx > 0.0f ? h10 : h00;
+                hb = dx > 0.0f ? h11 : h01;
+            } else {
+                t = 2.0f * std::abs(dz);
+                w = (dx / std::abs(dz) + 1.0f) * 0.5f;
+                ha = dz > 0.0f ? h01 : h00;
+                hb = dz > 0.0f ? h11 : h10;
+            }
+
+            const f32 approx = hc + t * ((1.0f - w) * ha + w * hb - hc);
+            const bool on_border = x == 0 || z == 0 || x == last || z == last;
+            if (std::abs(approx - h(x, z)) > (on_border ? border_error : max_error)) return false;
+        }
+    }
+    return true;
+}
+
+// leaves has room for every square of the grid, the most a quadtree can produce.
+void collectLeaves(const f32* heights, int verts_per_side, int x0, int z0, int size,
+                   f32 max_error, f32 border_error, QuadLeaf* leaves, size_t& leafCount)
+{
+    if (size == 1 || fanWithinError(heights, verts_per_side, x0, z0, size, max_error, border_error)) {
+        leaves[leafCount++] = QuadLeaf{x0, z0, size};
+        return;
+    }
+
+    const int half = size / 2;
+    collectLeaves(heights, verts_per_side, x0, z0, half, max_error, border_error, leaves, leafCount);
+    collectLeaves(heights, verts_per_side, x0 + half, z0, half, max_error, border_error, leaves, leafCount);
+    collectLeaves(heights, verts_per_side, x0, z0 + half, half, max_error, border_error, leaves, leafCount);
+    collectLeaves(heights, verts_per_side, x0 + half, z0 + half, half, max_error, border_error, leaves, leafCount);
+}
+
+// Triangles over grid vertex ids from a restricted quadtree. Each leaf is a fan around its centre
+// through every perimeter vertex some neighbouring leaf uses, so there are no T-junctions.
+void triangulateQuadtree(const f32* heights, int squares_per_side, f32 max_error, f32 border_error,
+                         ScratchArena& arena, std::vector<i32>& indices)
+{
+    TRACE_ZONE("triangulate quadtree");
+
+    const int verts_per_side = squares_per_side + 1;
+    const size_t grid_count = static_cast<size_t>(verts_per_side) * verts_per_side;
+
+    QuadLeaf* leaves = arena.allocate<QuadLeaf>(static_cast<size_t>(squares_per_side) * squares_per_side);
+    size_t leaf_count = 0;
+    collectLeaves(heights, verts_per_side, 0, 0, squares_per_side, max_error, border_error, leaves, leaf_count);
+
+    u8* used = arena.allocate<u8>(grid_count);
+    std::fill(used, used + grid_count, u8(0));
+    auto vid = [verts_per_side](int vx, int vz) -> int {
+        return vz * verts_per_side + vx;
+    };
+
+    for (size_t l = 0; l < leaf_count; l++) {
+        const QuadLeaf& leaf = leaves[l];
+        used[vid(leaf.x0, leaf.z0)] = 1;
+        used[vid(leaf.x0 + leaf.size, leaf.z0)] = 1;
+        used[vid(leaf.x0, leaf.z0 + leaf.size)] = 1;
+        used[vid(leaf.x0 + leaf.size, leaf.z0 + leaf.size)] = 1;
+    }
+
+    indices.clear();
+    i32* perimeter = arena.allocate<i32>(static_cast<size_t>(squares_per_side) * 4);
+    size_t perimeter_count = 0;
+
+    for (size_t l = 0; l < leaf_count; l++) {
+        const QuadLeaf& leaf = leaves[l];
+        const int x1 = leaf.x0 + leaf.size;
+        const int z1 = leaf.z0 + leaf.size;
+
+        if (leaf.size == 1) {
+            const int v00 = vid(leaf.x0, leaf.z0);
+            const int v10 = vid(x1, leaf.z0);
+            const int v01 = vid(leaf.x0, z1);
+            const int v11 = vid(x1, z1);
+
+            indices.push_back(v00);
+            indices.push_back(v11);
+            indices.push_back(v01);
+            indices.push_back(v00);
+            indices.push_back(v10);
+            indices.push_back(v11);
+            continue;
+        }
+
+        // Counter-clockwise in (x, z), matching the winding of the plain grid.
+        perimeter_count = 0;
+        for (int x = leaf.x0; x < x1; x++)      if (used[vid(x, leaf.z0)]) perimeter[perimeter_count++] = vid(x, leaf.z0);
+        for (int z = leaf.z0; z < z1; z++)      if (used[vid(x1, z)])      perimeter[perimeter_count++] = vid(x1, z);
+        for (int x = x1; x > leaf.x0; x--)      if (used[vid(x, z1)])      perimeter[perimeter_count++] = vid(x, z1);
+        for (int z = z1; z > leaf.z0; z--)      if (used[vid(leaf.x0, z)]) perimeter[perimeter_count++] = vid(leaf.x0, z);
+
+        const int center = vid(leaf.x0 + leaf.size / 2, leaf.z0 + leaf.size / 2);
+        for (size_t i = 0; i < perimeter_count; i++) {
+            indices.push_back(center);
+            indices.push_back(perimeter[i]);
+            indices.push_back(perimeter[(i + 1) % perimeter_count]);
+        }
+    }
+}
+
+[[nodiscard]] bool isPowerOfTwo(int v) noexcept {
+    return v > 0 && (v & (v - 1)) == 0;
+}
+
+// Triangles over grid vertex ids; submerged quads are greedily merged into flat rectangles.
+// Returns true for the plain grid, where every grid vertex ends up referenced.
+bool triangulateGrid(const Heightfield& heightfield, f32 water, ScratchArena& arena, std::vector<i32>& indices)
+{
+    TRACE_ZONE("triangulate grid");
+
+    const int squares_per_side = heightfield.layout.squaresPerSide;
+    const int verts_per_side = heightfield.layout.vertsPerSide;
+
+    auto vid = [verts_per_side](int vx, int vz) -> int {
+        return vz * verts_per_side + vx;
+    };
+
+    auto emitRect = [&](int x0, int z0, int x1, int z1) {
+        const int v00 = vid(x0, z0);
+        const int v10 = vid(x1, z0);
+        const int v01 = vid(x0, z1);
+        const int v11 = vid(x1, z1);
+
+        indices.push_back(v00);
+        indices.push_back(v11);
+        indices.push_back(v01);
+        indices.push_back(v00);
+        indices.push_back(v10);
+        indices.push_back(v11);
+    };
+
+    indices.clear();
+
+    // Fully submerged chunk: one quad
+    if (heightfield.maxSample <= water) {
+        if (squares_per_side > 0) emitRect(0, 0, squares_per_side, squares_per_side);
+        return false;
+    }
+
+    const size_t quad_count = static_cast<size_t>(squares_per_side) * squares_per_side;
+
+    // Dry chunk: plain grid, written straight into the sized buffer
+    if (heightfield.minSample > water) {
+        indices.resize(quad_count * 6);
+        i32* w = indices.data();
+        for (int z = 0; z < squares_per_side; z++) {
+            for (int x = 0; x < squares_per_side; x++, w += 6) {
+                const int v00 = vid(x, z);
+                const int v01 = v00 + verts_per_side;
+                w[0] = v00;
+                w[1] = v01 + 1;
+                w[2] = v01;
+                w[3] = v00;
+                w[4] = v00 + 1;
+                w[5] = v01 + 1;
+            }
+        }
+        return squares_per_side > 0;
+    }
+
+    indices.reserve(quad_count * 6);
+
+    u8* submerged = arena.allocate<u8>(quad_count);
+    u8* consumed = arena.allocate<u8>(quad_count);
+    std::fill(consumed, consumed + quad_count, u8(0));
+
+    for (int z = 0; z < squares_per_side; z++) {
+        for (int x = 0; x < squares_per_side; x++) {
+            const f32 top = std::max(
+                std::max(heightfield.at(x, z), heightfield.at(x + 1, z)),
+                std::max(heightfield.at(x, z + 1), heightfield.at(x + 1, z + 1)));
+            submerged[static_cast<size_t>(z) * squares_per_side + x] = top <= water ? 1 : 0;
+        }
+    }
+
+    auto mergeable = [&](int x, int z) {
+        const size_t q = static_cast<size_t>(z) * squares_per_side + x;
+        return submerged[q] && !consumed[q];
+    };
+
+    for (int z = 0; z < squares_per_side; z++) {
+        for (int x = 0; x < squares_per_side; x++) {
+            if (consumed[static_cast<size_t>(z) * squares_per_side + x]) continue;
+
+            if (!submerged[static_cast<size_t>(z) * squares_per_side + x]) {
+                emitRect(x, z, x + 1, z + 1);
+                continue;
+            }
+
+            int x1 = x + 1;
+            while (x1 < squares_per_side && mergeable(x1, z)) x1++;
+
+            int z1 = z + 1;
+            for (; z1 < squares_per_side; z1++) {
+                bool row = true;
+                for (int rx = x; rx < x1 && row; rx++) row = mergeable(rx, z1);
+                if (!row) break;
+            }
+
+            for (int rz = z; rz < z1; rz++) {
+                for (int rx = x; rx < x1; rx++) {
+                    consumed[static_cast<size_t>(rz) * squares_per_side + rx] = 1;
+                }
+            }
+
+            emitRect(x, z, x1, z1);
+        }
+    }
+    return false;
+}
+
+// Heights, normals, triangles and vertex attributes of one chunk.
+void buildGridMesh(const Heightfield& heightfield, const ChunkMeshSettings& settings, ScratchArena& arena, ChunkMeshData& out)
+{
+    const int squares_per_side = heightfield.layout.squaresPerSide;
+    const int verts_per_side = heightfield.layout.vertsPerSide;
+    const int grid_count = verts_per_side * verts_per_side;
+    const f32 water = static_cast<f32>(settings.waterLevel);
+    const f32 quad_size = static_cast<f32>(settings.tileWidth) * static_cast<f32>(heightfield.layout.step);
+
+    // Set to water level if below
+    f32* heights = arena.allocate<f32>(static_cast<size_t>(grid_count));
+    const f32* samples = heightfield.samples.data();
+    for (int i = 0; i < grid_count; i++) {
+        f64 noiseValue = samples[i];
+        if (noiseValue <= settings.waterLevel) {
+            noiseValue = settings.waterLevel;
+        }
+        heights[i] = static_cast<f32>(noiseValue * settings.tileHeight);
+    }
+
+    f32* grid_normals = arena.allocate<f32>(static_cast<size_t>(grid_count) * 3);
+    computeGridNormals(heights, squares_per_side, quad_size, arena, grid_normals);
+
+    out.uniformTriangleCount = static_cast<u32>(squares_per_side) * static_cast<u32>(squares_per_side) * 2u;
+
+    bool all_used = false;
+    if (settings.simplify && isPowerOfTwo(squares_per_side) && heightfield.maxSample > water) {
+        const f32 border_error = 1e-5f * static_cast<f32>(std::abs(settings.tileHeight)) + 1e-6f;
+        triangulateQuadtree(heights, squares_per_side, std::max(0.0f, settings.simplifyError), border_error, arena, out.indices);
+    } else {
+        all_used = triangulateGrid(heightfield, water, arena, out.indices);
+    }
+
+    const f32 uv_scale = (verts_per_side > 1) ? 1.0f / static_cast<f32>(verts_per_side - 1) : 0.0f;
+    out.weights.clear();
+
+    // Plain grid: vertices are the grid itself, no remap
+    if (all_used) {
+        const size_t vertex_count = static_cast<size_t>(grid_count);
+        out.gridIndices.resize(vertex_count);
+        out.positions.resize(vertex_count * 3);
+        out.normals.assign(grid_normals, grid_normals + vertex_count * 3);
+        out.uvs.resize(vertex_count * 2);
+
+        size_t i = 0;
+        for (int vz = 0; vz < verts_per_side; vz++) {
+            for (int vx = 0; vx < verts_per_side; vx++, i++) {
+                out.gridIndices[i] = static_cast<i32>(i);
+                out.positions[i * 3 + 0] = static_cast<f32>(vx) * quad_size;
+                out.positions[i * 3 + 1] = heights[i];
+                out.positions[i * 3 + 2] = static_cast<f32>(vz) * quad_size;
+                out.uvs[i * 2 + 0] = static_cast<f32>(vx) * uv_scale;
+                out.uvs[i * 2 + 1] = static_cast<f32>(vz) * uv_scale;
+            }
+        }
+        return;
+    }
+
+    // Keep only the grid vertices the triangles reference
+    i32* remap = arena.allocate<i32>(static_cast<size_t>(grid_count));
+    std::fill(remap, remap + grid_count, -1);
+    for (const i32 g : out.indices) remap[g] = 0;
+
+    out.gridIndices.clear();
+    for (int g = 0; g < grid_count; g++) {
+        if (remap[g] < 0) continue;
+        remap[g] = static_cast<i32>(out.gridIndices.size());
+        out.gridIndices.push_back(g);
+    }
+
+    for (i32& index : out.indices) index = remap[index];
+
+    const size_t vertex_count = out.gridIndices.size();
+    out.positions.resize(vertex_count * 3);
+    out.normals.resize(vertex_count * 3);
+    out.uvs.resize(vertex_count * 2);
+
+    for (size_t i = 0; i < vertex_count; i++) {
+        const i32 g = out.gridIndices[i];
+        const int vx = g % verts_per_side;
+        const int vz = g / verts_per_side;
+
+        out.positions[i * 3 + 0] = static_cast<f32>(vx) * quad_size;
+        out.positions[i * 3 + 1] = heights[g];
+        out.positions[i * 3 + 2] = static_cast<f32>(vz) * quad_size;
+
+        out.normals[i * 3 + 0] = grid_normals[g * 3 + 0];
+        out.normals[i * 3 + 1] = grid_normals[g * 3 + 1];
+        out.normals[i * 3 + 2] = grid_normals[g * 3 + 2];
+
+        out.uvs[i * 2 + 0] = static_cast<f32>(vx) * uv_scale;
+        out.uvs[i * 2 + 1] = static_cast<f32>(vz) * uv_scale;
+    }
+}
+
+} 
+
+size_t chunkMeshScratchBytes(u16 chunkSize) noexcept
+{
+    const size_t squares = chunkSize;
+    const size_t grid = (squares + 1) * (squares + 1);
+
+    // heights, normals and remap, plus the largest of the face normals, the two triangulations and
+    // the morph parent grid, plus alignment padding
+    const size_t common = grid * sizeof(f32) * 4 + grid * sizeof(i32);
+    const size_t faces = squares * squares * 6 * sizeof(f32);
+    const size_t plain = squares * squares * 2;
+    const size_t quadtree = squares * squares * sizeof(QuadLeaf) + grid + squares * 4 * sizeof(i32);
+    return common + std::max({ faces, plain, quadtree }) + 256;
+}
+
+void chunkHeightRange(const Heightfield& heightfield, const ChunkMeshSettings& settings, f32& minHeight, f32& maxHeight) noexcept
+{
+    const f64 lo = std::max(static_cast<f64>(heightfield.minSample), settings.waterLevel) * settings.tileHeight;
+    const f64 hi = std::max(static_cast<f64>(heightfield.maxSample), settings.waterLevel) * settings.tileHeight;
+    minHeight = static_cast<f32>(std::min(lo, hi));
+    maxHeight = static_cast<f32>(std::max(lo, hi));
+}
+
+void computeMorphTargets(const Heightfield& heightfield, const ChunkMeshSettings& settings, ChunkMeshData& out)
+{
+    TRACE_ZONE("morph targets");
+
+    const i32 verts_per_side = heightfield.layout.vertsPerSide;
+    const i32 last = verts_per_side - 1;
+
+    // Same rounding as the mesh positions, so shared vertices morph onto themselves exactly.
+    auto h = [&](i32 vx, i32 vz) {
+        const f64 sample = heightfield.at(std::clamp(vx, 0, last), std::clamp(vz, 0, last));
+        return static_cast<f32>(std::max(sample, settings.waterLevel) * settings.tileHeight);
+    };
+
+    // Parent grid normals the way the coarser LOD computes them: every other sample, twice the quad
+    // size. An odd grid repeats its last sample to fill the parent's last row and column.
+    ScratchArena& arena = ScratchArena::local();
+    const ScratchScope scratch(arena);
+
+    const i32 parent_squares = (last + 1) / 2;
+    const i32 parent_verts = parent_squares + 1;
+    const size_t parent_count = static_cast<size_t>(parent_verts) * parent_verts;
+    f32* parent_heights = arena.allocate<f32>(parent_count);
+    for (i32 pz = 0; pz < parent_verts; pz++) {
+        for (i32 px = 0; px < parent_verts; px++) {
+            parent_heights[static_cast<size_t>(pz) * parent_verts + px] = h(px * 2, pz * 2);
+        }
+    }
+
+    f32* parent_normals = arena.allocate<f32>(parent_count * 3);
+    const f32 parent_quad = 2.0f * static_cast<f32>(settings.tileWidth) * static_cast<f32>(heightfield.layout.step);
+    if (parent_squares > 0) {
+        computeGridNormals(parent_heights, parent_squares, parent_quad, arena, parent_normals);
+    } else {
+        parent_normals[0] = 0.0f;
+        parent_normals[1] = 1.0f;
+        parent_normals[2] = 0.0f;
+    }
+
+    auto pn = [&](i32 vx, i32 vz) {
+        return parent_normals + (static_cast<size_t>(vz / 2) * parent_verts + vx / 2) * 3;
+    };
+
+    const size_t vertex_count = out.gridIndices.size();
+    out.morphTargets.resize(vertex_count * 4);
+
+    for (size_t i = 0; i < vertex_count; i++) {
+        const i32 g = out.gridIndices[i];
+        const i32 vx = g % verts_per_side;
+        const i32 vz = g / verts_per_side;
+        const bool odd_x = (vx & 1) != 0;
+        const bool odd_z = (vz & 1) != 0;
+
+        // Both ends of the parent edge or diagonal the vertex sits on; the same vertex twice if shared.
+        i32 ax = vx, az = vz, bx = vx, bz = vz;
+        if (odd_x) {
+            ax = vx - 1;
+            bx = vx + 1;
+        }
+        if (odd_z) {
+            az = vz - 1;
+            bz = vz + 1;
+        }
+
+        const f32 parent = (odd_x || odd_z) ? 0.5f * (h(ax, az) + h(bx, bz)) : h(vx, vz);
+
+        const f32* na = pn(ax, az);
+        const f32* nb = pn(bx, bz);
+        f32 nx = na[0] + nb[0];
+        f32 ny = na[1] + nb[1];
+        f32 nz = na[2] + nb[2];
+        const f32 len = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (len > 0.0f) {
+            nx /= len;
+            ny /= len;
+            nz /= len;
+        } else {
+            nx = 0.0f;
+            ny = 1.0f;
+            nz = 0.0f;
+        }
+
+        f32* target = &out.morphTargets[i * 4];
+        target[0] = parent;
+        target[1] = nx;
+        target[2] = ny;
+        target[3] = nz;
+    }
+}
+
+void buildChunkMesh(
+    const Heightfield& heightfield,
+    const ChunkMeshSettings& settings,
+    const NoiseGenerator* biomeNoise,
+    ChunkMeshData& out)
+{
+    TRACE_ZONE("build chunk mesh");
+
+    // Scratch lives until the chunk is done; sized up front so the first chunk already fits.
+    ScratchArena& arena = ScratchArena::local();
+    arena.reserve(chunkMeshScratchBytes(settings.chunkSize));
+    const ScratchScope scratch(arena);
+
+    buildGridMesh(heightfield, settings, arena, out);
+
+    if (settings.splat.enabled) {
+        computeSplatWeights(heightfield, settings, biomeNoise, out);
+    }
+
+    if (settings.morph) {
+        computeMorphTargets(heightfield, settings, out);
+    } else {
+        out.morphTargets.clear();
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "heightfield.h"
+
+// std
+#include <vector>
+
+// Per-vertex material weights, baked once per chunk instead of per pixel in the shader.
+// Channels: r = grass, g = rock, b = sand, a = snow.
+struct SplatSettings
+{
+    bool enabled = false;
+    f32 sand_height = 0.04f; // normalized band above the water level
+    f32 snow_height = 0.75f; // normalized height where snow starts
+    f32 rock_slope = 0.35f;  // 1 - normal.y where rock starts
+    f32 blend = 0.05f;       // transition width of every threshold
+
+    // Secondary biome noise turning grass into sand where it is dry. 0 disables it.
+    f32 biome_frequency = 0.0f;
+};
+
+struct ChunkMeshSettings
+{
+    u16 chunkSize = 32;
+    f64 tileWidth = 1.0;
+    f64 tileHeight = 10.0;
+    f64 waterLevel = 0.0;
+    SplatSettings splat;
+
+    // Restricted quadtree simplification; needs a power of two squares per side.
+    bool simplify = false;
+    f32 simplifyError = 0.05f; // max vertical error in world units
+
+    // Also store, per vertex, the height and normal of the next coarser LOD for geomorphing.
+    bool morph = false;
+};
+
+// Godot-free mesh arrays of one chunk, positions local to the chunk origin.
+struct ChunkMeshData
+{
+    std::vector<f32> positions; // xyz
+    std::vector<f32> normals;   // xyz
+    std::vector<f32> uvs;       // uv
+    std::vector<u8> weights;    // rgba8, empty unless splat weights are enabled
+    std::vector<f32> morphTargets; // parent LOD height and normal xyz per vertex, empty unless morphing
+    std::vector<i32> indices;
+    std::vector<i32> gridIndices; // heightfield sample each vertex was taken from
+    u32 uniformTriangleCount = 0; // what the plain grid would have emitted
+
+    // Empties every array but keeps its capacity, so a reused instance stops allocating.
+    void clear() noexcept {
+        positions.clear();
+        normals.clear();
+        uvs.clear();
+        weights.clear();
+        morphTargets.clear();
+        indices.clear();
+        gridIndices.clear();
+        uniformTriangleCount = 0;
+    }
+
+    [[nodiscard]] size_t triangleCount() const noexcept { return indices.size() / 3; }
+    [[nodiscard]] size_t vertexCount() const noexcept { return positions.size() / 3; }
+};
+
+// Scratch arena bytes buildChunkMesh needs for a chunk of this size at LOD0, the largest grid.
+[[nodiscard]] size_t chunkMeshScratchBytes(u16 chunkSize) noexcept;
+
+// Height range of the chunk surface in world units, water floor included. Every mesh vertex is a
+// heightfield sample, so this bounds the mesh at any LOD and with simplification.
+void chunkHeightRange(const Heightfield& heightfield, const ChunkMeshSettings& settings, f32& minHeight, f32& maxHeight) noexcept;
+
+// Fills morphTargets from gridIndices: the height and unit normal the uniform grid of the next coarser
+// LOD has under each vertex, following its v00-v11 diagonal. Vertices the parent shares keep their own
+// height and take the normal the parent mesh gives them.
+void computeMorphTargets(const Heightfield& heightfield, const ChunkMeshSettings& settings, ChunkMeshData& out);
+
+// Quads lying entirely below the water level are merged into as few flat rectangles as possible,
+// so a fully submerged chunk becomes a single quad. With simplify set, the grid is instead reduced
+// to quadtree leaves under the error bound; chunk border vertices are only dropped where they are
+// collinear, so neighbours built at the same LOD still meet. Normals always come from the full grid.
+// biomeNoise may be null; it is only sampled when splat weights and the biome frequency are enabled.
+// Scratch comes from the calling thread's ScratchArena, so once a reused out has grown, building
+// allocates nothing.
+void buildChunkMesh(
+    const Heightfield& heightfield,
+    const ChunkMeshSettings& settings,
+    const NoiseGenerator* biomeNoise,
+    ChunkMeshData& out);
@@ -0,0 +1,83 @@
+#include "chunk_streamer.h"
+
+// std
+#include <algorithm>
+#include <limits>
+
+void ChunkStreamer::configure(const StreamingSettings& settings) noexcept
+{
+    settings_ = settings;
+}
+
+const StreamingSettings& ChunkStreamer::settings() const noexcept
+{
+    return settings_;
+}
+
+TerrainLevelOfDetail ChunkStreamer::lodForDistance(i64 distChunks) const noexcept
+{
+    if (distChunks <= settings_.lodLevel0Distance) return TerrainLevelOfDetail::LEVEL_0;
+    if (distChunks <= settings_.lodLevel1Distance) return TerrainLevelOfDetail::LEVEL_1;
+    if (distChunks <= settings_.lodLevel2Distance) return TerrainLevelOfDetail::LEVEL_2;
+    return TerrainLevelOfDetail::LEVEL_3;
+}
+
+TerrainLevelOfDetail ChunkStreamer::lodWithHysteresis(i64 distChunks, TerrainLevelOfDetail current) const noexcept
+{
+    const TerrainLevelOfDetail hard = lodForDistance(distChunks);
+    const i64 margin = std::max(0, settings_.lodHysteresis);
+
+    if (hard < current) {
+        // Moving in: refine only once the chunk is margin chunks inside the finer ring.
+        const TerrainLevelOfDetail inner = lodForDistance(distChunks + margin);
+        return inner < current ? inner : current;
+    }
+
+    if (hard > current) {
+        // Moving out: coarsen only once margin chunks past the threshold.
+        const TerrainLevelOfDetail outer = lodForDistance(std::max<i64>(0, distChunks - margin));
+        return outer > current ? outer : current;
+    }
+
+    return current;
+}
+
+i64 ChunkStreamer::lodKeptUntil(TerrainLevelOfDetail lod) const noexcept
+{
+    // Walk outwards with the rule planBuilds applies, so anything derived from it matches the switch.
+    i64 dist = 0;
+    while (dist < settings_.viewRadius && lodWithHysteresis(dist + 1, lod) <= lod) dist++;
+    return dist;
+}
+
+i64 ChunkStreamer::nearestViewerDistance(const ChunkCoord& coord, const std::vector<ChunkCoord>& viewers) const noexcept
+{
+    i64 best = std::numeric_limits<i64>::max();
+    for (const ChunkCoord& viewer : viewers) {
+        best = std::min(best, chebyshevDist(coord.x - viewer.x, coord.z - viewer.z));
+    }
+    return best;
+}
+
+std::optional<TerrainLevelOfDetail> ChunkStreamer::desiredLod(
+    const ChunkCoord& coord,
+    const std::vector<ChunkCoord>& viewers,
+    std::optional<TerrainLevelOfDetail> current) const noexcept
+{
+    const i64 dist = nearestViewerDistance(coord, viewers);
+    if (dist > settings_.viewRadius) return std::nullopt;
+    return current ? lodWithHysteresis(dist, *current) : lodForDistance(dist);
+}
+
+u32 ChunkStreamer::countReferences(const ChunkCoord& coord, const std::vector<ChunkCoord>& viewers) const noexcept
+{
+    const i64 unload2 = static_cast<i64>(settings_.unloadRadius) * settings_.unloadRadius;
+
+    u32 count = 0;
+    for (const ChunkCoord& viewer : viewers) {
+        const i64 dx = coord.x - viewer.x;
+        const i64 dz = coord.z - viewer.z;
+        if (dx * dx + dz * dz <= unload2) count++;
+    }
+    return count;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "chunk_types.h"
+
+// std
+#include <algorithm>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+struct BuildRequest {
+    ChunkCoord coord;
+    TerrainLevelOfDetail lod;
+};
+
+struct StreamingSettings
+{
+    i32 viewRadius = 8;
+    i32 unloadRadius = 12;
+
+    i32 lodLevel0Distance = 2;
+    i32 lodLevel1Distance = 4;
+    i32 lodLevel2Distance = 7;
+
+    // Chunks a resident chunk must be past a LOD threshold before it switches, so viewers pacing
+    // across a ring edge do not rebuild the whole ring on every crossing.
+    i32 lodHysteresis = 1;
+};
+
+[[nodiscard]] inline i64 chebyshevDist(i64 dx, i64 dz) noexcept {
+    return std::max(dx < 0 ? -dx : dx, dz < 0 ? -dz : dz);
+}
+
+// Decides what a set of viewers needs: the union of their view windows, every chunk at the LOD
+// of its nearest viewer, and how many viewers still hold on to a resident chunk.
+// Godot-free so streaming can be replayed outside the engine.
+class ChunkStreamer
+{
+
+public:
+    void configure(const StreamingSettings& settings) noexcept;
+    [[nodiscard]] const StreamingSettings& settings() const noexcept;
+
+    [[nodiscard]] TerrainLevelOfDetail lodForDistance(i64 distChunks) const noexcept;
+
+    // LOD for a chunk that currently has current: it only moves once past the threshold by the margin.
+    [[nodiscard]] TerrainLevelOfDetail lodWithHysteresis(i64 distChunks, TerrainLevelOfDetail current) const noexcept;
+
+    // Farthest distance in chunks at which a chunk already at lod keeps it, hysteresis included.
+    [[nodiscard]] i64 lodKeptUntil(TerrainLevelOfDetail lod) const noexcept;
+
+    // Chebyshev distance in chunks to the nearest viewer.
+    [[nodiscard]] i64 nearestViewerDistance(const ChunkCoord& coord, const std::vector<ChunkCoord>& viewers) const noexcept;
+
+    // LOD the chunk should have, or nothing if it lies outside every view window. current is the LOD
+    // it is resident at, if any, and enables hysteresis.
+    [[nodiscard]] std::optional<TerrainLevelOfDetail> desiredLod(
+        const ChunkCoord& coord,
+        const std::vector<ChunkCoord>& viewers,
+        std::optional<TerrainLevelOfDetail> current = std::nullopt) const noexcept;
+
+    // Viewers whose unload radius still covers the chunk; zero means it can go.
+    [[nodiscard]] u32 countReferences(const ChunkCoord& coord, const std::vector<ChunkCoord>& viewers) const noexcept;
+
+    // Appends a build for every chunk in the union of view windows that needsBuild(coord, lod) reports
+    // as missing or stale, nearest first. currentLod(coord) returns the resident LOD, if any.
+    // Returns how many chunks crossed a hard LOD threshold since the last plan but were kept by hysteresis.
+    template <typename CurrentLod, typename NeedsBuild>
+    u32 planBuilds(const std::vector<ChunkCoord>& viewers, CurrentLod&& currentLod, NeedsBuild&& needsBuild, std::vector<BuildRequest>& out);
+
+private:
+    StreamingSettings settings_;
+
+    // Scratch reused between plans
+    std::unordered_set<ChunkCoord, ChunkCoordHash> visited_;
+    std::vector<std::pair<i64, BuildRequest>> planned_;
+    std::vector<ChunkCoord> previousViewers_; // viewers of the last plan
+};
+
+template <typename CurrentLod, typename NeedsBuild>
+u32 ChunkStreamer::planBuilds(const std::vector<ChunkCoord>& viewers, CurrentLod&& currentLod, NeedsBuild&& needsBuild, std::vector<BuildRequest>& out)
+{
+    visited_.clear();
+    planned_.clear();
+
+    const i32 r = settings_.viewRadius;
+    u32 avoided = 0;
+
+    for (const ChunkCoord& viewer : viewers) {
+        for (i32 dz = -r; dz <= r; dz++) {
+            for (i32 dx = -r; dx <= r; dx++) {
+                const ChunkCoord c{ viewer.x + dx, viewer.z + dz };
+                if (!visited_.insert(c).second) continue;
+
+                const i64 dist = nearestViewerDistance(c, viewers);
+                const std::optional<TerrainLevelOfDetail> current = currentLod(c);
+                const TerrainLevelOfDetail desired = current ? lodWithHysteresis(dist, *current) : lodForDistance(dist);
+
+                // Hard thresholds would have rebuilt this chunk on this move.
+                if (current && desired == *current && !previousViewers_.empty()) {
+                    const TerrainLevelOfDetail hard = lodForDistance(dist);
+                    if (hard != *current && hard != lodForDistance(nearestViewerDistance(c, previousViewers_))) {
+                        avoided++;
+                    }
+                }
+
+                // Not loaded or loaded at the wrong LOD -> schedule (re)build
+                if (needsBuild(c, desired)) {
+                    planned_.emplace_back(dist, BuildRequest{c, desired});
+                }
+            }
+        }
+    }
+
+    std::stable_sort(planned_.begin(), planned_.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    for (const auto& [dist, request] : planned_) {
+        out.push_back(request);
+    }
+
+    previousViewers_ = viewers;
+    return avoided;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "utils.h"
+
+// std
+#include <functional>
+
+enum class TerrainLevelOfDetail : u8
+{
+	LEVEL_0 = 0,
+	LEVEL_1 = 1,
+	LEVEL_2 = 2,
+	LEVEL_3 = 3
+};
+
+// Chunk coordinates stay 64-bit so they never limit the world size, only float precision does.
+struct ChunkCoord {
+    i64 x;
+    i64 z;
+
+    bool operator==(const ChunkCoord& o) const noexcept {
+        return x == o.x && z == o.z;
+    }
+};
+
+struct ChunkCoordHash {
+    size_t operator()(const ChunkCoord& c) const noexcept {
+        size_t h1 = std::hash<i64>{}(c.x);
+        size_t h2 = std::hash<i64>{}(c.z);
+        size_t h = h1;
+        h ^= h2 + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+// Integer division rounding towards negative infinity, so chunk -1 lands in region -1.
+[[nodiscard]] inline i64 floorDiv(i64 a, i64 b) noexcept {
+    const i64 q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
@@ -0,0 +1,170 @@
+#include "heightfield.h"
+#include "trace.h"
+
+// std
+#include <algorithm>
+#include <limits>
+
+ChunkGridLayout chunkGridLayout(u16 chunkSize, TerrainLevelOfDetail lod) noexcept
+{
+    int lod_i = static_cast<int>(lod);
+    lod_i = std::clamp(lod_i, 0, 6);
+
+    // Ensure step <= chunkSize
+    while ((1 << lod_i) > static_cast<int>(chunkSize) && lod_i > 0) {
+        lod_i--;
+    }
+
+    ChunkGridLayout layout;
+    layout.step = 1 << lod_i;
+    layout.squaresPerSide = static_cast<i32>(chunkSize) / layout.step;
+    layout.vertsPerSide = layout.squaresPerSide + 1;
+    return layout;
+}
+
+std::shared_ptr<Heightfield> sampleHeightfield(
+    const NoiseGenerator& noise,
+    const ChunkCoord& coord,
+    TerrainLevelOfDetail lod,
+    u16 chunkSize,
+    f64 tileWidth)
+{
+    TRACE_ZONE("sample heightfield");
+
+    auto heightfield = std::make_shared<Heightfield>();
+    heightfield->coord = coord;
+    heightfield->lod = lod;
+    heightfield->layout = chunkGridLayout(chunkSize, lod);
+
+    const i32 verts_per_side = heightfield->layout.vertsPerSide;
+    const f64 quad_size = tileWidth * static_cast<f64>(heightfield->layout.step);
+    const f64 chunk_world_x0 = static_cast<f64>(coord.x) * static_cast<f64>(chunkSize) * tileWidth;
+    const f64 chunk_world_z0 = static_cast<f64>(coord.z) * static_cast<f64>(chunkSize) * tileWidth;
+
+    heightfield->samples.resize(static_cast<size_t>(verts_per_side) * verts_per_side);
+
+    // Bounds are tracked while sampling, so AABBs and occlusion need no second pass.
+    f32 lo = std::numeric_limits<f32>::max();
+    f32 hi = std::numeric_limits<f32>::lowest();
+
+    for (i32 vz = 0; vz < verts_per_side; vz++) {
+        const f64 world_z = chunk_world_z0 + static_cast<f64>(vz) * quad_size;
+        for (i32 vx = 0; vx < verts_per_side; vx++) {
+            const f64 world_x = chunk_world_x0 + static_cast<f64>(vx) * quad_size;
+            const f32 sample = static_cast<f32>(noise.getNoiseValue(world_x, world_z));
+            heightfield->samples[static_cast<size_t>(vz) * verts_per_side + vx] = sample;
+            lo = std::min(lo, sample);
+            hi = std::max(hi, sample);
+        }
+    }
+
+    heightfield->minSample = lo;
+    heightfield->maxSample = hi;
+    return heightfield;
+}
+
+f32 interpolateHeightfield(const Heightfield& heightfield, f32 gx, f32 gz, f32 floorValue) noexcept
+{
+    const i32 last = heightfield.layout.vertsPerSide - 1;
+    if (last <= 0) return std::max(heightfield.samples.empty() ? 0.0f : heightfield.samples[0], floorValue);
+
+    gx = std::clamp(gx, 0.0f, static_cast<f32>(last));
+    gz = std::clamp(gz, 0.0f, static_cast<f32>(last));
+
+    const i32 x0 = std::min(static_cast<i32>(gx), last - 1);
+    const i32 z0 = std::min(static_cast<i32>(gz), last - 1);
+    const f32 u = gx - static_cast<f32>(x0);
+    const f32 v = gz - static_cast<f32>(z0);
+
+    const f32 h00 = std::max(heightfield.at(x0, z0), floorValue);
+    const f32 h10 = std::max(heightfield.at(x0 + 1, z0), floorValue);
+    const f32 h01 = std::max(heightfield.at(x0, z0 + 1), floorValue);
+    const f32 h11 = std::max(heightfield.at(x0 + 1, z0 + 1), floorValue);
+
+    if (u >= v) {
+        return h00 + (h10 - h00) * u + (h11 - h10) * v;
+    }
+    return h00 + (h11 - h01) * u + (h01 - h00) * v;
+}
+
+void updateHeightfieldBounds(Heightfield& heightfield) noexcept
+{
+    if (heightfield.samples.empty()) {
+        heightfield.minSample = heightfield.maxSample = 0.0f;
+        return;
+    }
+
+    const auto [lo, hi] = std::minmax_element(heightfield.samples.begin(), heightfield.samples.end());
+    heightfield.minSample = *lo;
+    heightfield.maxSample = *hi;
+}
+
+HeightfieldCache::HeightfieldCache(size_t capacity)
+: capacity_(capacity)
+{
+}
+
+std::shared_ptr<const Heightfield> HeightfieldCache::find(const ChunkCoord& coord, TerrainLevelOfDetail lod)
+{
+    auto it = index_.find(Key{coord, lod});
+    if (it == index_.end()) return nullptr;
+
+    // Move to front
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return *it->second;
+}
+
+void HeightfieldCache::insert(std::shared_ptr<const Heightfield> heightfield)
+{
+    if (!heightfield || capacity_ == 0) return;
+
+    const Key key{heightfield->coord, heightfield->lod};
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        *it->second = std::move(heightfield);
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.push_front(std::move(heightfield));
+    index_.emplace(key, lru_.begin());
+    evictOverCapacity();
+}
+
+void HeightfieldCache::eraseIf(const std::function<bool(const Heightfield&)>& predicate)
+{
+    for (auto it = lru_.begin(); it != lru_.end(); ) {
+        if (predicate(**it)) {
+            index_.erase(Key{(*it)->coord, (*it)->lod});
+            it = lru_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void HeightfieldCache::clear() noexcept
+{
+    lru_.clear();
+    index_.clear();
+}
+
+void HeightfieldCache::setCapacity(size_t capacity)
+{
+    capacity_ = capacity;
+    evictOverCapacity();
+}
+
+size_t HeightfieldCache::size() const noexcept
+{
+    return lru_.size();
+}
+
+void HeightfieldCache::evictOverCapacity()
+{
+    while (lru_.size() > capacity_) {
+        const auto& oldest = lru_.back();
+        index_.erase(Key{oldest->coord, oldest->lod});
+        lru_.pop_back();
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "chunk_types.h"
+#include "noise_generator.h"
+
+// std
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Vertex grid of a chunk at a given LOD.
+struct ChunkGridLayout
+{
+    i32 step = 1;
+    i32 squaresPerSide = 0;
+    i32 vertsPerSide = 1;
+};
+
+[[nodiscard]] ChunkGridLayout chunkGridLayout(u16 chunkSize, TerrainLevelOfDetail lod) noexcept;
+
+// Noise samples of one chunk, normalized to [0, 1] and not yet clamped to the water level.
+struct Heightfield
+{
+    ChunkCoord coord{0, 0};
+    TerrainLevelOfDetail lod = TerrainLevelOfDetail::LEVEL_0;
+    ChunkGridLayout layout;
+    std::vector<f32> samples; // row major: vz * vertsPerSide + vx
+    f32 minSample = 0.0f;
+    f32 maxSample = 0.0f;
+    bool eroded = false;
+
+    [[nodiscard]] f32 at(i32 vx, i32 vz) const noexcept {
+        return samples[static_cast<size_t>(vz) * layout.vertsPerSide + vx];
+    }
+};
+
+[[nodiscard]] std::shared_ptr<Heightfield> sampleHeightfield(
+    const NoiseGenerator& noise,
+    const ChunkCoord& coord,
+    TerrainLevelOfDetail lod,
+    u16 chunkSize,
+    f64 tileWidth);
+
+// Height on the chunk surface at fractional grid coordinates, following the mesh triangulation
+// (diagonal from v00 to v11). Corners below floorValue are raised to it first, like the mesh does.
+[[nodiscard]] f32 interpolateHeightfield(const Heightfield& heightfield, f32 gx, f32 gz, f32 floorValue) noexcept;
+
+// Recomputes minSample/maxSample after the samples were written.
+void updateHeightfieldBounds(Heightfield& heightfield) noexcept;
+
+// LRU cache of chunk heightfields keyed by chunk and LOD. Main thread only.
+class HeightfieldCache
+{
+
+public:
+    explicit HeightfieldCache(size_t capacity = 1024);
+
+public:
+    [[nodiscard]] std::shared_ptr<const Heightfield> find(const ChunkCoord& coord, TerrainLevelOfDetail lod);
+    void insert(std::shared_ptr<const Heightfield> heightfield);
+    void eraseIf(const std::function<bool(const Heightfield&)>& predicate);
+    void clear() noexcept;
+
+    void setCapacity(size_t capacity);
+    [[nodiscard]] size_t size() const noexcept;
+
+private:
+    struct Key {
+        ChunkCoord coord;
+        TerrainLevelOfDetail lod;
+
+        bool operator==(const Key& o) const noexcept {
+            return coord == o.coord && lod == o.lod;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const noexcept {
+            return ChunkCoordHash{}(k.coord) * 31u + static_cast<size_t>(k.lod);
+        }
+    };
+
+    using Lru = std::list<std::shared_ptr<const Heightfield>>;
+
+    void evictOverCapacity();
+
+private:
+    size_t capacity_;
+    Lru lru_; // most recently used first
+    std::unordered_map<Key, Lru::iterator, KeyHash> index_;
+};
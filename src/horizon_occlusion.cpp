@@ -0,0 +1,116 @@
+#include "horizon_occlusion.h"
+#include "trace.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+
+constexpr f32 pi = 3.14159265358979f;
+
+[[nodiscard]] f32 wrapAngle(f32 a) noexcept {
+    while (a > pi) a -= 2.0f * pi;
+    while (a <= -pi) a += 2.0f * pi;
+    return a;
+}
+
+}
+
+HorizonOcclusion::HorizonOcclusion(u32 rays)
+: rays_(std::max(8u, rays))
+{
+}
+
+f32 HorizonOcclusion::rayOf(f32 angle) const noexcept
+{
+    return (angle + pi) / (2.0f * pi) * static_cast<f32>(rays_);
+}
+
+void HorizonOcclusion::compute(f32 eyeX, f32 eyeY, f32 eyeZ, const std::vector<OcclusionBox>& boxes, f32 margin, std::vector<u8>& occluded)
+{
+    TRACE_ZONE("horizon occlusion");
+
+    const size_t count = boxes.size();
+    occluded.assign(count, 0);
+    extents_.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        const OcclusionBox& b = boxes[i];
+        Extent& e = extents_[i];
+
+        const f32 dx = std::max({ b.x0 - eyeX, 0.0f, eyeX - b.x1 });
+        const f32 dz = std::max({ b.z0 - eyeZ, 0.0f, eyeZ - b.z1 });
+        e.nearDist = std::sqrt(dx * dx + dz * dz);
+
+        const f32 fx = std::max(std::abs(b.x0 - eyeX), std::abs(b.x1 - eyeX));
+        const f32 fz = std::max(std::abs(b.z0 - eyeZ), std::abs(b.z1 - eyeZ));
+        e.farDist = std::sqrt(fx * fx + fz * fz);
+
+        if (e.nearDist <= 0.0f) continue; // the eye stands on it
+
+        // The footprint spans less than half a turn from outside, so corner angles around the
+        // centre direction give the extent without wrap-around trouble.
+        const f32 center = std::atan2((b.z0 + b.z1) * 0.5f - eyeZ, (b.x0 + b.x1) * 0.5f - eyeX);
+        const f32 corners_x[4] = { b.x0, b.x1, b.x0, b.x1 };
+        const f32 corners_z[4] = { b.z0, b.z0, b.z1, b.z1 };
+
+        f32 lo = 0.0f;
+        f32 hi = 0.0f;
+        for (i32 c = 0; c < 4; c++) {
+            const f32 delta = wrapAngle(std::atan2(corners_z[c] - eyeZ, corners_x[c] - eyeX) - center);
+            lo = std::min(lo, delta);
+            hi = std::max(hi, delta);
+        }
+
+        // Rays whose direction falls inside the extent; none for a sliver between two rays.
+        e.firstRay = static_cast<i32>(std::ceil(rayOf(center + lo)));
+        e.lastRay = static_cast<i32>(std::floor(rayOf(center + hi)));
+    }
+
+    byNear_.resize(count);
+    std::iota(byNear_.begin(), byNear_.end(), 0u);
+    std::sort(byNear_.begin(), byNear_.end(), [this](u32 a, u32 b) { return extents_[a].nearDist < extents_[b].nearDist; });
+
+    byFar_.resize(count);
+    std::iota(byFar_.begin(), byFar_.end(), 0u);
+    std::sort(byFar_.begin(), byFar_.end(), [this](u32 a, u32 b) { return extents_[a].farDist < extents_[b].farDist; });
+
+    horizon_.assign(rays_, std::numeric_limits<f32>::lowest());
+    const i32 n = static_cast<i32>(rays_);
+    size_t next_occluder = 0;
+
+    for (const u32 i : byNear_) {
+        const Extent& e = extents_[i];
+        if (e.nearDist <= 0.0f || e.firstRay > e.lastRay) continue;
+
+        // Boxes wholly in front of this one may hide it.
+        while (next_occluder < count && extents_[byFar_[next_occluder]].farDist <= e.nearDist) {
+            const u32 o = byFar_[next_occluder++];
+            const Extent& oe = extents_[o];
+            if (oe.nearDist <= 0.0f) continue;
+
+            // A ray crossing the footprint meets terrain at least minY high somewhere between
+            // nearDist and farDist.
+            const f32 rise = boxes[o].minY - eyeY;
+            const f32 blocked = rise / (rise >= 0.0f ? oe.farDist : oe.nearDist);
+
+            for (i32 k = oe.firstRay; k <= oe.lastRay; k++) {
+                f32& h = horizon_[((k % n) + n) % n];
+                h = std::max(h, blocked);
+            }
+        }
+
+        const f32 rise = boxes[i].maxY + margin - eyeY;
+        const f32 highest = rise / (rise >= 0.0f ? e.nearDist : e.farDist);
+
+        bool hidden = true;
+        for (i32 k = e.firstRay; k <= e.lastRay && hidden; k++) {
+            hidden = highest < horizon_[((k % n) + n) % n];
+        }
+        occluded[i] = hidden ? 1 : 0;
+    }
+}
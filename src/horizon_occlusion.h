@@ -0,0 +1,51 @@
+#pragma once
+
+#include "utils.h"
+
+// std
+#include <vector>
+
+// Chunk footprint [x0, x1] x [z0, z1] and its surface height range, in the eye's space.
+struct OcclusionBox
+{
+    f32 x0 = 0.0f;
+    f32 z0 = 0.0f;
+    f32 x1 = 0.0f;
+    f32 z1 = 0.0f;
+    f32 minY = 0.0f;
+    f32 maxY = 0.0f;
+};
+
+// CPU horizon test for heightfield terrain. Boxes are walked front to back while a fan of rays around
+// the eye records, per ray, the lowest elevation some closer box is guaranteed to block. A box is
+// occluded when its highest point stays under the horizon on every ray through it. Occluders only
+// count for boxes entirely behind them, so the test is conservative up to the spacing of the rays.
+class HorizonOcclusion
+{
+
+public:
+    explicit HorizonOcclusion(u32 rays = 1024);
+
+public:
+    // occluded[i] becomes 1 for every box hidden from the eye. margin is added to every box top,
+    // so chunks peeking barely above a ridge stay shown.
+    void compute(f32 eyeX, f32 eyeY, f32 eyeZ, const std::vector<OcclusionBox>& boxes, f32 margin, std::vector<u8>& occluded);
+
+private:
+    struct Extent {
+        f32 nearDist = 0.0f;
+        f32 farDist = 0.0f;
+        i32 firstRay = 0; // rays through the footprint, inclusive and unwrapped
+        i32 lastRay = -1;
+    };
+
+    // Fractional ray index of an azimuth in (-pi, pi].
+    [[nodiscard]] f32 rayOf(f32 angle) const noexcept;
+
+private:
+    u32 rays_;
+    std::vector<f32> horizon_;
+    std::vector<Extent> extents_;
+    std::vector<u32> byNear_;
+    std::vector<u32> byFar_;
+};
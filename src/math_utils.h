@@ -0,0 +1,13 @@
+#pragma once
+
+#include "utils.h"
+
+// std
+#include <algorithm>
+
+// Hermite step from 0 at edge0 to 1 at edge1; a degenerate range becomes a hard step at edge0.
+[[nodiscard]] inline f32 smoothstep(f32 edge0, f32 edge1, f32 x) noexcept {
+    if (edge1 <= edge0) return x < edge0 ? 0.0f : 1.0f;
+    const f32 t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "chunk_types.h"
+
+// Small deterministic random stream, so generated content only depends on seed and coordinates.
+class SplitMix64
+{
+
+public:
+    explicit SplitMix64(u64 seed) : state_(seed) {}
+
+public:
+    u64 next() noexcept {
+        u64 z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    f32 nextUnit() noexcept {
+        return static_cast<f32>(next() >> 40) / static_cast<f32>(1ULL << 24);
+    }
+
+private:
+    u64 state_;
+};
+
+[[nodiscard]] inline u64 coordSeed(i32 seed, const ChunkCoord& coord, u64 salt = 0) noexcept {
+    u64 h = static_cast<u64>(static_cast<u32>(seed)) ^ salt;
+    h = h * 0x100000001b3ULL ^ static_cast<u64>(coord.x);
+    h = h * 0x100000001b3ULL ^ static_cast<u64>(coord.z);
+    return h;
+}
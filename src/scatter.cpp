@@ -0,0 +1,152 @@
+#include "scatter.h"
+#include "math_utils.h"
+#include "random.h"
+#include "worker_pool.h"
+#include "trace.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+constexpr u64 scatterSalt = 0x5ca77e5ULL;
+
+} 
+
+void generateScatter(
+    const Heightfield& heightfield,
+    const ChunkMeshSettings& meshSettings,
+    const ScatterSettings& settings,
+    const NoiseGenerator* densityNoise,
+    i32 seed,
+    ScatterData& out)
+{
+    TRACE_ZONE("generate scatter");
+
+    out.coord = heightfield.coord;
+    out.instanceCount = 0;
+    out.transforms.clear();
+
+    const i32 lod_i = static_cast<i32>(heightfield.lod);
+    if (lod_i > settings.max_lod || settings.density <= 0.0f || meshSettings.chunkSize == 0) return;
+
+    const f32 keep = std::pow(settings.lod_falloff, static_cast<f32>(lod_i));
+    const f32 water = static_cast<f32>(meshSettings.waterLevel);
+    const f32 no_floor = -std::numeric_limits<f32>::infinity();
+
+    const f32 chunk_tiles = static_cast<f32>(meshSettings.chunkSize);
+    const i32 cells_per_side = std::max(1, static_cast<i32>(std::lround(chunk_tiles * std::sqrt(settings.density))));
+    const f32 cell_tiles = chunk_tiles / static_cast<f32>(cells_per_side);
+    const f32 step = static_cast<f32>(heightfield.layout.step);
+    const f32 tile_width = static_cast<f32>(meshSettings.tileWidth);
+    const f32 tile_height = static_cast<f32>(meshSettings.tileHeight);
+
+    const f64 chunk_world_x0 = static_cast<f64>(heightfield.coord.x) * chunk_tiles * meshSettings.tileWidth;
+    const f64 chunk_world_z0 = static_cast<f64>(heightfield.coord.z) * chunk_tiles * meshSettings.tileWidth;
+
+    // Central differences over half a grid cell, converted to world units.
+    const f32 e = 0.5f;
+    const f32 slope_scale = (tile_width > 0.0f) ? tile_height / (2.0f * e * step * tile_width) : 0.0f;
+
+    out.transforms.reserve(static_cast<size_t>(cells_per_side) * cells_per_side * keep * 12);
+
+    SplitMix64 rng(coordSeed(seed, heightfield.coord, scatterSalt));
+
+    for (i32 cz = 0; cz < cells_per_side; cz++) {
+        for (i32 cx = 0; cx < cells_per_side; cx++) {
+            // Always draw the same numbers per cell so the stream does not depend on what got rejected.
+            const f32 jx = rng.nextUnit();
+            const f32 jz = rng.nextUnit();
+            const f32 rank = rng.nextUnit();
+            const f32 angle = rng.nextUnit() * 6.2831853f;
+            const f32 scale_t = rng.nextUnit();
+
+            if (rank >= keep) continue;
+
+            const f32 tx = (static_cast<f32>(cx) + jx) * cell_tiles;
+            const f32 tz = (static_cast<f32>(cz) + jz) * cell_tiles;
+
+            if (densityNoise) {
+                const f64 wx = chunk_world_x0 + static_cast<f64>(tx) * meshSettings.tileWidth;
+                const f64 wz = chunk_world_z0 + static_cast<f64>(tz) * meshSettings.tileWidth;
+                const f32 map = smoothstep(0.35f, 0.65f, static_cast<f32>(densityNoise->getNoiseValue(wx, wz)));
+                if (rank >= keep * map) continue;
+            }
+
+            const f32 gx = tx / step;
+            const f32 gz = tz / step;
+
+            const f32 raw = interpolateHeightfield(heightfield, gx, gz, no_floor);
+            if (raw <= water) continue; // no grass on the sea floor
+
+            const f32 dhdx = (interpolateHeightfield(heightfield, gx + e, gz, water) - interpolateHeightfield(heightfield, gx - e, gz, water)) * slope_scale;
+            const f32 dhdz = (interpolateHeightfield(heightfield, gx, gz + e, water) - interpolateHeightfield(heightfield, gx, gz - e, water)) * slope_scale;
+            const f32 normal_y = 1.0f / std::sqrt(1.0f + dhdx * dhdx + dhdz * dhdz);
+            if (1.0f - normal_y > settings.max_slope) continue;
+
+            const f32 s = settings.min_scale + (settings.max_scale - settings.min_scale) * scale_t;
+            const f32 c = std::cos(angle) * s;
+            const f32 sn = std::sin(angle) * s;
+
+            // Rows of the 3x4 matrix: rotation around Y, uniform scale, origin.
+            const f32 m[12] = {
+                c,   0.0f, sn, tx * tile_width,
+                0.0f, s,   0.0f, raw * tile_height,
+                -sn, 0.0f, c,  tz * tile_width,
+            };
+            out.transforms.insert(out.transforms.end(), m, m + 12);
+            out.instanceCount++;
+        }
+    }
+}
+
+ScatterScheduler::ScatterScheduler()
+: state_(std::make_shared<SharedState>())
+{
+}
+
+void ScatterScheduler::schedule(
+    std::shared_ptr<const Heightfield> heightfield,
+    u32 buildId,
+    const ChunkMeshSettings& meshSettings,
+    const ScatterSettings& settings,
+    std::shared_ptr<const NoiseGenerator> densityNoise,
+    i32 seed,
+    WorkerPool& pool)
+{
+    u64 generation;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        generation = state_->generation;
+    }
+
+    pool.submit([state = state_, generation, heightfield = std::move(heightfield), buildId,
+                 meshSettings, settings, densityNoise = std::move(densityNoise), seed]() {
+        ScatterData data;
+        generateScatter(*heightfield, meshSettings, settings, densityNoise.get(), seed, data);
+        data.buildId = buildId;
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->generation != generation) return;
+        state->completed.push_back(std::move(data));
+    });
+}
+
+void ScatterScheduler::takeCompleted(std::vector<ScatterData>& out)
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for (ScatterData& data : state_->completed) {
+        out.push_back(std::move(data));
+    }
+    state_->completed.clear();
+}
+
+void ScatterScheduler::clear()
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->generation++;
+    state_->completed.clear();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "chunk_mesh_builder.h"
+
+// std
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class WorkerPool;
+
+struct ScatterSettings
+{
+    bool enabled = false;
+    f32 density = 0.2f;       // instances per tile at LOD0
+    i32 max_lod = 1;          // chunks coarser than this get no instances
+    f32 lod_falloff = 0.35f;  // density multiplier per LOD step
+    f32 max_slope = 0.3f;     // 1 - normal.y above which nothing is placed
+    f32 min_scale = 0.8f;
+    f32 max_scale = 1.2f;
+
+    // Density map: low-frequency noise thinning instances out into patches. 0 disables it.
+    f32 density_frequency = 0.0f;
+};
+
+// Instance transforms of one chunk in MultiMesh TRANSFORM_3D layout (12 floats per instance),
+// local to the chunk origin.
+struct ScatterData
+{
+    ChunkCoord coord{0, 0};
+    u32 buildId = 0;
+    u32 instanceCount = 0;
+    std::vector<f32> transforms;
+};
+
+// Deterministic per chunk: candidates come from a fixed LOD0 jitter grid and each carries a rank,
+// so coarser LODs keep a subset of the same instances instead of reshuffling them.
+void generateScatter(
+    const Heightfield& heightfield,
+    const ChunkMeshSettings& meshSettings,
+    const ScatterSettings& settings,
+    const NoiseGenerator* densityNoise,
+    i32 seed,
+    ScatterData& out);
+
+// Runs generateScatter on the worker pool and hands results back to the main thread.
+class ScatterScheduler
+{
+
+public:
+    ScatterScheduler();
+
+public:
+    void schedule(
+        std::shared_ptr<const Heightfield> heightfield,
+        u32 buildId,
+        const ChunkMeshSettings& meshSettings,
+        const ScatterSettings& settings,
+        std::shared_ptr<const NoiseGenerator> densityNoise,
+        i32 seed,
+        WorkerPool& pool);
+
+    void takeCompleted(std::vector<ScatterData>& out);
+    void clear();
+
+private:
+    struct SharedState {
+        std::mutex mutex;
+        std::vector<ScatterData> completed;
+        u64 generation = 0;
+    };
+
+private:
+    std::shared_ptr<SharedState> state_;
+};
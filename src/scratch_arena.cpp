@@ -0,0 +1,57 @@
+#include "scratch_arena.h"
+
+// std
+#include <algorithm>
+
+ScratchArena& ScratchArena::local()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void ScratchArena::reserve(size_t bytes)
+{
+    if (used_ != 0 || !overflow_.empty() || bytes <= capacity_) return;
+
+    block_ = std::make_unique<std::byte[]>(bytes);
+    capacity_ = bytes;
+}
+
+void ScratchArena::rewind(size_t mark) noexcept
+{
+    used_ = std::min(mark, used_);
+    if (used_ != 0 || overflow_.empty()) return;
+
+    // Fully released after spilling: replace the block with one that fits the peak, plus room for
+    // alignment padding. Growth is rare and best effort, a failed allocation just keeps spilling.
+    overflow_.clear();
+    overflowBytes_ = 0;
+    try {
+        reserve(peak_ + 256);
+    } catch (...) {
+    }
+}
+
+void ScratchArena::resetStats() noexcept
+{
+    peak_ = used_ + overflowBytes_;
+    overflows_ = 0;
+}
+
+void* ScratchArena::allocateBytes(size_t bytes, size_t alignment)
+{
+    const size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+
+    if (offset + bytes <= capacity_) {
+        used_ = offset + bytes;
+        peak_ = std::max(peak_, used_ + overflowBytes_);
+        return block_.get() + offset;
+    }
+
+    // The heap keeps max_align_t alignment, enough for every allowed type.
+    overflow_.push_back(std::make_unique<std::byte[]>(std::max<size_t>(bytes, 1)));
+    overflowBytes_ += bytes;
+    overflows_++;
+    peak_ = std::max(peak_, used_ + overflowBytes_);
+    return overflow_.back().get();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "utils.h"
+
+// std
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for the scratch arrays of one chunk: height grids, normals, triangulation state.
+// Every thread owns one (local()), and a ScratchScope hands the memory back once the chunk is done.
+// Requests past the block come from the heap and are counted; the next full rewind grows the block
+// to the peak seen, so steady-state generation stops allocating.
+class ScratchArena
+{
+
+public:
+    ScratchArena() = default;
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+public:
+    [[nodiscard]] static ScratchArena& local();
+
+    // Uninitialized storage for count values; released only by rewinding.
+    template <typename T>
+    [[nodiscard]] T* allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "arena memory is never destroyed");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned scratch type");
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    // Grows the block to at least bytes. Ignored while anything is allocated.
+    void reserve(size_t bytes);
+
+    [[nodiscard]] size_t mark() const noexcept { return used_; }
+    void rewind(size_t mark) noexcept;
+
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] size_t peakBytes() const noexcept { return peak_; }
+    [[nodiscard]] u64 overflowCount() const noexcept { return overflows_; }
+    void resetStats() noexcept;
+
+private:
+    [[nodiscard]] void* allocateBytes(size_t bytes, size_t alignment);
+
+private:
+    std::unique_ptr<std::byte[]> block_;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    size_t overflowBytes_ = 0;
+    size_t peak_ = 0; // block and overflow bytes live at once
+    u64 overflows_ = 0;
+    std::vector<std::unique_ptr<std::byte[]>> overflow_;
+};
+
+// Rewinds the arena to where it was on construction.
+class ScratchScope
+{
+
+public:
+    explicit ScratchScope(ScratchArena& arena) noexcept
+    : arena_(arena), mark_(arena.mark())
+    {
+    }
+
+    ~ScratchScope() { arena_.rewind(mark_); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+private:
+    ScratchArena& arena_;
+    size_t mark_;
+};
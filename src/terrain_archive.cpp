@@ -0,0 +1,652 @@
+#include "terrain_archive.h"
+#include "trace.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+
+namespace
+{
+
+constexpr u8 archiveMagic[4] = { 'T', 'G', 'A', 'R' };
+constexpr u32 archiveVersion = 4;
+constexpr size_t headerBytes = 80;
+constexpr size_t indexEntryBytes = 12;
+constexpr size_t slotBytes = 12;
+constexpr u32 emptyChunk = 0xFFFFFFFFu;
+
+constexpr u8 headerFlagEroded = 1;
+constexpr u8 headerFlagMeshes = 2;
+constexpr u8 chunkFlagMesh = 1;
+
+// Fixed quantization range; noise is [0, 1], erosion may push slightly past either end.
+constexpr f32 quantMin = -0.25f;
+constexpr f32 quantRange = 1.5f;
+constexpr i32 quantMax = 65535;
+
+// Plain memcpy serialization: every platform we ship on is little-endian.
+struct ByteWriter
+{
+    std::vector<u8>& out;
+
+    template <typename T>
+    void pod(const T& value) {
+        const size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    void varint(u64 value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<u8>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<u8>(value));
+    }
+};
+
+struct ByteReader
+{
+    const u8 *data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    bool ok = true;
+
+    template <typename T>
+    [[nodiscard]] T pod() {
+        T value{};
+        if (pos + sizeof(T) > size) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    [[nodiscard]] u64 varint() {
+        u64 value = 0;
+        for (u32 shift = 0; shift < 64; shift += 7) {
+            if (pos >= size) break;
+            const u8 b = data[pos++];
+            value |= static_cast<u64>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) return value;
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+[[nodiscard]] u32 zigzag(i32 v) noexcept {
+    return (static_cast<u32>(v) << 1) ^ static_cast<u32>(v >> 31);
+}
+
+[[nodiscard]] i32 unzigzag(u32 v) noexcept {
+    return static_cast<i32>(v >> 1) ^ -static_cast<i32>(v & 1);
+}
+
+[[nodiscard]] u16 quantize(f32 sample) noexcept {
+    const f32 t = (sample - quantMin) / quantRange;
+    return static_cast<u16>(std::clamp(static_cast<i32>(std::lround(t * static_cast<f32>(quantMax))), 0, quantMax));
+}
+
+[[nodiscard]] f32 dequantize(u16 q) noexcept {
+    return quantMin + static_cast<f32>(q) * (quantRange / static_cast<f32>(quantMax));
+}
+
+// Planar predictor (left + up - up-left); smooth terrain leaves residuals of a few units.
+[[nodiscard]] i32 predict(const std::vector<u16>& q, i32 n, i32 x, i32 z) noexcept {
+    const size_t i = static_cast<size_t>(z) * n + x;
+    if (x > 0 && z > 0) {
+        const i32 p = static_cast<i32>(q[i - 1]) + static_cast<i32>(q[i - n]) - static_cast<i32>(q[i - n - 1]);
+        return std::clamp(p, 0, quantMax);
+    }
+    if (x > 0) return q[i - 1];
+    if (z > 0) return q[i - n];
+    return 0;
+}
+
+[[nodiscard]] f32 signNotZero(f32 v) noexcept {
+    return v < 0.0f ? -1.0f : 1.0f;
+}
+
+// Octahedral normal encoding around +Y, the axis terrain normals lean towards.
+void octEncode(f32 x, f32 y, f32 z, i16& u, i16& v) noexcept {
+    const f32 l1 = std::abs(x) + std::abs(y) + std::abs(z);
+    f32 ox = l1 > 0.0f ? x / l1 : 0.0f;
+    f32 oz = l1 > 0.0f ? z / l1 : 0.0f;
+    if (y < 0.0f) {
+        const f32 fx = (1.0f - std::abs(oz)) * signNotZero(ox);
+        const f32 fz = (1.0f - std::abs(ox)) * signNotZero(oz);
+        ox = fx;
+        oz = fz;
+    }
+    u = static_cast<i16>(std::lround(std::clamp(ox, -1.0f, 1.0f) * 32767.0f));
+    v = static_cast<i16>(std::lround(std::clamp(oz, -1.0f, 1.0f) * 32767.0f));
+}
+
+void octDecode(i16 u, i16 v, f32 *out) noexcept {
+    f32 x = static_cast<f32>(u) / 32767.0f;
+    f32 z = static_cast<f32>(v) / 32767.0f;
+    const f32 y = 1.0f - std::abs(x) - std::abs(z);
+    if (y < 0.0f) {
+        const f32 fx = (1.0f - std::abs(z)) * signNotZero(x);
+        const f32 fz = (1.0f - std::abs(x)) * signNotZero(z);
+        x = fx;
+        z = fz;
+    }
+    const f32 len = std::sqrt(x * x + y * y + z * z);
+    out[0] = x / len;
+    out[1] = y / len;
+    out[2] = z / len;
+}
+
+[[nodiscard]] i32 lod0VertsPerSide(const TerrainArchiveHeader& header) noexcept {
+    return static_cast<i32>(header.chunkSize) + 1;
+}
+
+// Sides of a chunk on the outer border of the baked rectangle, where it meets generated chunks.
+struct OuterSides {
+    bool minX = false;
+    bool maxX = false;
+    bool minZ = false;
+    bool maxZ = false;
+
+    [[nodiscard]] bool any() const noexcept { return minX || maxX || minZ || maxZ; }
+    [[nodiscard]] bool contains(i32 x, i32 z, i32 n) const noexcept {
+        return (minX && x == 0) || (maxX && x == n - 1) || (minZ && z == 0) || (maxZ && z == n - 1);
+    }
+};
+
+[[nodiscard]] OuterSides outerSides(const TerrainArchiveHeader& header, const ChunkCoord& coord) noexcept {
+    OuterSides sides;
+    sides.minX = coord.x == header.minChunkX;
+    sides.maxX = coord.x == header.minChunkX + header.chunksX - 1;
+    sides.minZ = coord.z == header.minChunkZ;
+    sides.maxZ = coord.z == header.minChunkZ + header.chunksZ - 1;
+    return sides;
+}
+
+void serializeHeader(const TerrainArchiveHeader& header, std::vector<u8>& out) {
+    ByteWriter w{out};
+    for (u8 c : archiveMagic) w.pod(c);
+    w.pod(archiveVersion);
+    w.pod(header.chunkSize);
+    w.pod(header.tileChunks);
+    w.pod(static_cast<u8>((header.eroded ? headerFlagEroded : 0) | (header.hasMeshes ? headerFlagMeshes : 0)));
+    w.pod(static_cast<u8>(0));
+    w.pod(static_cast<u16>(0));
+    w.pod(header.tileWidth);
+    w.pod(header.tileHeight);
+    w.pod(header.waterLevel);
+    w.pod(header.seed);
+    w.pod(header.simplifyError);
+    w.pod(header.minChunkX);
+    w.pod(header.minChunkZ);
+    w.pod(header.chunksX);
+    w.pod(header.chunksZ);
+    w.pod(header.generationHash);
+}
+
+[[nodiscard]] bool parseHeader(ByteReader& r, TerrainArchiveHeader& header) {
+    for (u8 c : archiveMagic) {
+        if (r.pod<u8>() != c) return false;
+    }
+    if (r.pod<u32>() != archiveVersion) return false;
+
+    header.chunkSize = r.pod<u16>();
+    header.tileChunks = r.pod<u16>();
+    const u8 flags = r.pod<u8>();
+    (void)r.pod<u8>();
+    (void)r.pod<u16>();
+    header.eroded = (flags & headerFlagEroded) != 0;
+    header.hasMeshes = (flags & headerFlagMeshes) != 0;
+    header.tileWidth = r.pod<f64>();
+    header.tileHeight = r.pod<f64>();
+    header.waterLevel = r.pod<f64>();
+    header.seed = r.pod<i32>();
+    header.simplifyError = r.pod<f32>();
+    header.minChunkX = r.pod<i64>();
+    header.minChunkZ = r.pod<i64>();
+    header.chunksX = r.pod<i32>();
+    header.chunksZ = r.pod<i32>();
+    header.generationHash = r.pod<u64>();
+
+    return r.ok && header.chunkSize > 0 && header.tileChunks > 0 && header.chunksX >= 0 && header.chunksZ >= 0;
+}
+
+void encodeChunk(const TerrainArchiveHeader& header, const BakedChunk& chunk, std::vector<u8>& out, f32& minSample, f32& maxSample) {
+    ByteWriter w{out};
+    const bool with_mesh = header.hasMeshes && !chunk.mesh.positions.empty();
+    w.pod(static_cast<u8>(with_mesh ? chunkFlagMesh : 0));
+
+    const Heightfield& heightfield = *chunk.heightfield;
+    const i32 n = lod0VertsPerSide(header);
+
+    std::vector<u16> q(heightfield.samples.size());
+    for (size_t i = 0; i < q.size(); i++) {
+        q[i] = quantize(heightfield.samples[i]);
+    }
+
+    minSample = dequantize(*std::min_element(q.begin(), q.end()));
+    maxSample = dequantize(*std::max_element(q.begin(), q.end()));
+
+    for (i32 z = 0; z < n; z++) {
+        for (i32 x = 0; x < n; x++) {
+            const i32 residual = static_cast<i32>(q[static_cast<size_t>(z) * n + x]) - predict(q, n, x, z);
+            w.varint(zigzag(residual));
+        }
+    }
+
+    // Samples shared with generated chunks outside the rectangle follow losslessly, row-major, and
+    // replace their quantized values on decode.
+    const OuterSides sides = outerSides(header, heightfield.coord);
+    if (sides.any()) {
+        for (i32 z = 0; z < n; z++) {
+            for (i32 x = 0; x < n; x++) {
+                if (!sides.contains(x, z, n)) continue;
+                const f32 sample = heightfield.samples[static_cast<size_t>(z) * n + x];
+                w.pod(sample);
+                minSample = std::min(minSample, sample);
+                maxSample = std::max(maxSample, sample);
+            }
+        }
+    }
+
+    if (!with_mesh) return;
+
+    // Every vertex sits on a grid sample, so positions and UVs follow from the grid index and the
+    // heights; only the triangulation and octahedral normals are stored.
+    const ChunkMeshData& mesh = chunk.mesh;
+    w.varint(mesh.vertexCount());
+    w.varint(mesh.indices.size());
+    w.varint(mesh.uniformTriangleCount);
+
+    i32 previous = 0;
+    for (i32 g : mesh.gridIndices) {
+        w.varint(zigzag(g - previous));
+        previous = g;
+    }
+
+    for (size_t i = 0; i < mesh.vertexCount(); i++) {
+        i16 u = 0;
+        i16 v = 0;
+        octEncode(mesh.normals[i * 3 + 0], mesh.normals[i * 3 + 1], mesh.normals[i * 3 + 2], u, v);
+        w.pod(u);
+        w.pod(v);
+    }
+
+    // Neighbouring triangles share vertices, so index deltas stay small.
+    previous = 0;
+    for (i32 index : mesh.indices) {
+        w.varint(zigzag(index - previous));
+        previous = index;
+    }
+}
+
+[[nodiscard]] bool decodeHeights(const TerrainArchiveHeader& header, const ChunkCoord& coord, ByteReader& r, std::vector<f32>& out) {
+    const i32 n = lod0VertsPerSide(header);
+    std::vector<u16> q(static_cast<size_t>(n) * n);
+
+    for (i32 z = 0; z < n; z++) {
+        for (i32 x = 0; x < n; x++) {
+            const i32 value = predict(q, n, x, z) + unzigzag(static_cast<u32>(r.varint()));
+            if (!r.ok || value < 0 || value > quantMax) return false;
+            q[static_cast<size_t>(z) * n + x] = static_cast<u16>(value);
+        }
+    }
+
+    out.resize(q.size());
+    for (size_t i = 0; i < q.size(); i++) {
+        out[i] = dequantize(q[i]);
+    }
+
+    const OuterSides sides = outerSides(header, coord);
+    if (sides.any()) {
+        for (i32 z = 0; z < n; z++) {
+            for (i32 x = 0; x < n; x++) {
+                if (sides.contains(x, z, n)) out[static_cast<size_t>(z) * n + x] = r.pod<f32>();
+            }
+        }
+    }
+    return r.ok;
+}
+
+}
+
+void encodeArchiveTile(const TerrainArchiveHeader& header, const std::vector<const BakedChunk*>& chunks, std::vector<u8>& out)
+{
+    out.clear();
+
+    const size_t slot_count = chunks.size();
+    const size_t table_bytes = sizeof(u32) + slot_count * slotBytes;
+    out.resize(table_bytes);
+
+    std::vector<u32> offsets(slot_count, emptyChunk);
+    std::vector<f32> mins(slot_count, 0.0f);
+    std::vector<f32> maxs(slot_count, 0.0f);
+
+    for (size_t s = 0; s < slot_count; s++) {
+        if (!chunks[s] || !chunks[s]->heightfield) continue;
+        offsets[s] = static_cast<u32>(out.size());
+        encodeChunk(header, *chunks[s], out, mins[s], maxs[s]);
+    }
+
+    // Fill in the slot table now that the offsets are known.
+    std::vector<u8> table;
+    table.reserve(table_bytes);
+    ByteWriter w{table};
+    w.pod(static_cast<u32>(slot_count));
+    for (size_t s = 0; s < slot_count; s++) {
+        w.pod(offsets[s]);
+        w.pod(mins[s]);
+        w.pod(maxs[s]);
+    }
+    std::copy(table.begin(), table.end(), out.begin());
+}
+
+bool writeTerrainArchive(std::ostream& out, const TerrainArchiveHeader& header, const std::vector<std::vector<u8>>& tiles)
+{
+    std::vector<u8> head;
+    serializeHeader(header, head);
+
+    ByteWriter w{head};
+    u64 offset = headerBytes + tiles.size() * indexEntryBytes;
+    for (const std::vector<u8>& tile : tiles) {
+        w.pod(offset);
+        w.pod(static_cast<u32>(tile.size()));
+        offset += tile.size();
+    }
+
+    out.write(reinterpret_cast<const char *>(head.data()), static_cast<std::streamsize>(head.size()));
+    for (const std::vector<u8>& tile : tiles) {
+        out.write(reinterpret_cast<const char *>(tile.data()), static_cast<std::streamsize>(tile.size()));
+    }
+    return static_cast<bool>(out);
+}
+
+TerrainArchive::TerrainArchive(size_t tileCacheCapacity)
+: tileCacheCapacity_(std::max<size_t>(1, tileCacheCapacity))
+{
+}
+
+u64 terrainGenerationHash(const NoiseSettings& noise, const ErosionSettings& erosion) noexcept
+{
+    // FNV-1a over the fields one by one, so struct padding never leaks into the value
+    u64 hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](auto value) {
+        u8 bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        for (const u8 b : bytes) {
+            hash ^= b;
+            hash *= 0x100000001b3ull;
+        }
+    };
+
+    mix(noise.seed);
+    mix(static_cast<i32>(noise.noise_type));
+    mix(noise.frequency);
+    mix(static_cast<i32>(noise.fractal_type));
+    mix(noise.octaves);
+    mix(noise.lacunarity);
+    mix(noise.gain);
+    mix(noise.weighted_strength);
+    mix(noise.ping_pong_strength);
+    mix(static_cast<u8>(noise.domain_warp_enabled));
+    mix(static_cast<i32>(noise.domain_warp_type));
+    mix(noise.domain_warp_amp);
+    mix(noise.height_scale);
+    mix(noise.height_offset);
+
+    // Erosion parameters do not matter while it is off
+    mix(static_cast<u8>(erosion.enabled));
+    if (erosion.enabled) {
+        mix(erosion.region_chunks);
+        mix(erosion.overlap);
+        mix(erosion.droplet_density);
+        mix(erosion.max_droplets);
+        mix(erosion.droplet_lifetime);
+        mix(erosion.inertia);
+        mix(erosion.sediment_capacity);
+        mix(erosion.min_sediment_capacity);
+        mix(erosion.erode_speed);
+        mix(erosion.deposit_speed);
+        mix(erosion.evaporate_speed);
+        mix(erosion.gravity);
+        mix(erosion.thermal_iterations);
+        mix(erosion.talus);
+        mix(erosion.thermal_rate);
+        mix(erosion.strength);
+    }
+    return hash;
+}
+
+bool TerrainArchive::open(ReadFn read)
+{
+    close();
+    read_ = std::move(read);
+
+    std::vector<u8> head(headerBytes);
+    if (!read_(0, head.data(), head.size())) return false;
+
+    ByteReader r{head.data(), head.size()};
+    if (!parseHeader(r, header_)) return false;
+
+    const size_t tile_count = static_cast<size_t>(header_.tilesX()) * static_cast<size_t>(header_.tilesZ());
+    std::vector<u8> table(tile_count * indexEntryBytes);
+    if (tile_count > 0 && !read_(headerBytes, table.data(), table.size())) return false;
+
+    ByteReader t{table.data(), table.size()};
+    index_.resize(tile_count);
+    for (TileEntry& entry : index_) {
+        entry.offset = t.pod<u64>();
+        entry.size = t.pod<u32>();
+    }
+
+    open_ = t.ok;
+    return open_;
+}
+
+void TerrainArchive::close() noexcept
+{
+    open_ = false;
+    read_ = nullptr;
+    header_ = TerrainArchiveHeader{};
+    index_.clear();
+    tileLru_.clear();
+    tiles_.clear();
+}
+
+bool TerrainArchive::isOpen() const noexcept
+{
+    return open_;
+}
+
+const TerrainArchiveHeader& TerrainArchive::header() const noexcept
+{
+    return header_;
+}
+
+std::shared_ptr<Heightfield> TerrainArchive::loadHeightfield(const ChunkCoord& coord, TerrainLevelOfDetail lod)
+{
+    TRACE_ZONE("archive heightfield");
+
+    ChunkRef ref;
+    if (!findChunk(coord, ref)) return nullptr;
+
+    const u32 offset = ref.tile->chunkOffsets[ref.slot];
+    ByteReader r{ref.tile->bytes.data(), ref.tile->bytes.size(), offset + 1};
+
+    std::vector<f32> lod0;
+    if (!decodeHeights(header_, coord, r, lod0)) return nullptr;
+
+    auto heightfield = std::make_shared<Heightfield>();
+    heightfield->coord = coord;
+    heightfield->lod = lod;
+    heightfield->layout = chunkGridLayout(header_.chunkSize, lod);
+    heightfield->eroded = header_.eroded;
+
+    // Coarser LODs sample the same world positions as every step-th LOD0 sample.
+    const i32 n = lod0VertsPerSide(header_);
+    const i32 verts_per_side = heightfield->layout.vertsPerSide;
+    const i32 step = heightfield->layout.step;
+
+    if (step == 1) {
+        heightfield->samples = std::move(lod0);
+    } else {
+        heightfield->samples.resize(static_cast<size_t>(verts_per_side) * verts_per_side);
+        for (i32 vz = 0; vz < verts_per_side; vz++) {
+            for (i32 vx = 0; vx < verts_per_side; vx++) {
+                heightfield->samples[static_cast<size_t>(vz) * verts_per_side + vx] =
+                    lod0[static_cast<size_t>(vz * step) * n + vx * step];
+            }
+        }
+    }
+
+    updateHeightfieldBounds(*heightfield);
+    return heightfield;
+}
+
+bool TerrainArchive::loadMesh(const ChunkCoord& coord, ChunkMeshData& out)
+{
+    TRACE_ZONE("archive mesh");
+
+    if (!header_.hasMeshes) return false;
+
+    ChunkRef ref;
+    if (!findChunk(coord, ref)) return false;
+
+    const u32 offset = ref.tile->chunkOffsets[ref.slot];
+    ByteReader r{ref.tile->bytes.data(), ref.tile->bytes.size(), offset};
+    const u8 flags = r.pod<u8>();
+    if (!r.ok || (flags & chunkFlagMesh) == 0) return false;
+
+    std::vector<f32> samples;
+    if (!decodeHeights(header_, coord, r, samples)) return false;
+
+    const size_t vertex_count = static_cast<size_t>(r.varint());
+    const size_t index_count = static_cast<size_t>(r.varint());
+    const u32 uniform_triangles = static_cast<u32>(r.varint());
+    if (!r.ok) return false;
+
+    out.clear();
+    out.uniformTriangleCount = uniform_triangles;
+    out.gridIndices.resize(vertex_count);
+    out.positions.resize(vertex_count * 3);
+    out.normals.resize(vertex_count * 3);
+    out.uvs.resize(vertex_count * 2);
+
+    // Rebuild positions and UVs the way buildChunkMesh lays them out.
+    const i32 n = lod0VertsPerSide(header_);
+    const f32 quad_size = static_cast<f32>(header_.tileWidth);
+    const f32 uv_scale = n > 1 ? 1.0f / static_cast<f32>(n - 1) : 0.0f;
+
+    i32 g = 0;
+    for (size_t i = 0; i < vertex_count; i++) {
+        g += unzigzag(static_cast<u32>(r.varint()));
+        if (!r.ok || g < 0 || static_cast<size_t>(g) >= samples.size()) return false;
+        out.gridIndices[i] = g;
+
+        const i32 vx = g % n;
+        const i32 vz = g / n;
+        const f64 sample = std::max(static_cast<f64>(samples[g]), header_.waterLevel);
+
+        out.positions[i * 3 + 0] = static_cast<f32>(vx) * quad_size;
+        out.positions[i * 3 + 1] = static_cast<f32>(sample * header_.tileHeight);
+        out.positions[i * 3 + 2] = static_cast<f32>(vz) * quad_size;
+        out.uvs[i * 2 + 0] = static_cast<f32>(vx) * uv_scale;
+        out.uvs[i * 2 + 1] = static_cast<f32>(vz) * uv_scale;
+    }
+
+    for (size_t i = 0; i < vertex_count; i++) {
+        const i16 u = r.pod<i16>();
+        const i16 v = r.pod<i16>();
+        octDecode(u, v, &out.normals[i * 3]);
+    }
+
+    out.indices.resize(index_count);
+    i32 previous = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        previous += unzigzag(static_cast<u32>(r.varint()));
+        if (previous < 0 || static_cast<size_t>(previous) >= vertex_count) return false;
+        out.indices[i] = previous;
+    }
+
+    return r.ok;
+}
+
+bool TerrainArchive::chunkBounds(const ChunkCoord& coord, f32& minSample, f32& maxSample)
+{
+    ChunkRef ref;
+    if (!findChunk(coord, ref)) return false;
+
+    minSample = ref.tile->minSamples[ref.slot];
+    maxSample = ref.tile->maxSamples[ref.slot];
+    return true;
+}
+
+bool TerrainArchive::findChunk(const ChunkCoord& coord, ChunkRef& out)
+{
+    if (!open_ || !header_.contains(coord)) return false;
+
+    const i64 cx = coord.x - header_.minChunkX;
+    const i64 cz = coord.z - header_.minChunkZ;
+    const i64 tile_x = cx / header_.tileChunks;
+    const i64 tile_z = cz / header_.tileChunks;
+
+    const Tile *tile = loadTile(static_cast<size_t>(tile_z * header_.tilesX() + tile_x));
+    if (!tile) return false;
+
+    const size_t slot = static_cast<size_t>((cz - tile_z * header_.tileChunks) * header_.tileChunks + (cx - tile_x * header_.tileChunks));
+    if (slot >= tile->chunkOffsets.size() || tile->chunkOffsets[slot] == emptyChunk) return false;
+
+    out.tile = tile;
+    out.slot = slot;
+    return true;
+}
+
+const TerrainArchive::Tile *TerrainArchive::loadTile(size_t index)
+{
+    auto found = tiles_.find(index);
+    if (found != tiles_.end()) {
+        tileLru_.splice(tileLru_.begin(), tileLru_, found->second.second);
+        return &found->second.first;
+    }
+
+    TRACE_ZONE("archive tile read");
+
+    if (index >= index_.size()) return nullptr;
+    const TileEntry& entry = index_[index];
+
+    Tile tile;
+    tile.bytes.resize(entry.size);
+    if (entry.size == 0 || !read_(entry.offset, tile.bytes.data(), tile.bytes.size())) return nullptr;
+
+    ByteReader r{tile.bytes.data(), tile.bytes.size()};
+    const u32 slot_count = r.pod<u32>();
+    if (!r.ok || slot_count != static_cast<u32>(header_.tileChunks) * header_.tileChunks) return nullptr;
+
+    tile.chunkOffsets.resize(slot_count);
+    tile.minSamples.resize(slot_count);
+    tile.maxSamples.resize(slot_count);
+    for (u32 s = 0; s < slot_count; s++) {
+        tile.chunkOffsets[s] = r.pod<u32>();
+        tile.minSamples[s] = r.pod<f32>();
+        tile.maxSamples[s] = r.pod<f32>();
+
+        if (tile.chunkOffsets[s] != emptyChunk && tile.chunkOffsets[s] >= tile.bytes.size()) return nullptr;
+    }
+    if (!r.ok) return nullptr;
+
+    tileLru_.push_front(index);
+    auto inserted = tiles_.emplace(index, std::make_pair(std::move(tile), tileLru_.begin())).first;
+
+    while (tiles_.size() > tileCacheCapacity_) {
+        tiles_.erase(tileLru_.back());
+        tileLru_.pop_back();
+    }
+
+    return &inserted->second.first;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "chunk_mesh_builder.h"
+#include "terrain_erosion.h"
+
+// std
+#include <functional>
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Baked terrain: LOD0 heightfields (and optionally LOD0 meshes without splat weights) of a rectangle
+// of chunks, grouped into tiles of tileChunks x tileChunks chunks. Every tile is compressed on its own
+// and listed in an index, so the runtime only reads the tiles it streams in.
+//
+// Heights are quantized to 16 bits over a fixed range shared by all chunks, so the samples two baked
+// neighbours share decode to the same value, then predicted from their neighbours and stored as
+// variable-length residuals. Samples on the outer border of the rectangle are also stored as exact
+// floats, so they match what a generated neighbour computes. Multi-byte values are little-endian.
+struct TerrainArchiveHeader
+{
+    u16 chunkSize = 32;
+    u16 tileChunks = 8;
+    f64 tileWidth = 1.0;
+    f64 tileHeight = 10.0;
+    f64 waterLevel = 0.0;
+    i32 seed = 0;
+    bool eroded = false;
+    bool hasMeshes = false;
+    f32 simplifyError = 0.0f; // error the meshes were simplified with, 0 for full grids
+    u64 generationHash = 0;   // terrainGenerationHash of the noise and erosion settings
+
+    // Baked rectangle in chunks
+    i64 minChunkX = 0;
+    i64 minChunkZ = 0;
+    i32 chunksX = 0;
+    i32 chunksZ = 0;
+
+    [[nodiscard]] i32 tilesX() const noexcept { return (chunksX + tileChunks - 1) / tileChunks; }
+    [[nodiscard]] i32 tilesZ() const noexcept { return (chunksZ + tileChunks - 1) / tileChunks; }
+    [[nodiscard]] bool contains(const ChunkCoord& coord) const noexcept {
+        return coord.x >= minChunkX && coord.x < minChunkX + chunksX
+            && coord.z >= minChunkZ && coord.z < minChunkZ + chunksZ;
+    }
+};
+
+// Fingerprint of every noise setting and, when erosion is enabled, every erosion setting. Baked
+// heights only line up with generated neighbours when the loading node computes the same value.
+[[nodiscard]] u64 terrainGenerationHash(const NoiseSettings& noise, const ErosionSettings& erosion) noexcept;
+
+// One chunk handed to the encoder. mesh is only written when the archive has meshes.
+struct BakedChunk
+{
+    std::shared_ptr<const Heightfield> heightfield; // LOD0
+    ChunkMeshData mesh;
+};
+
+// Encodes one tile. chunks holds tileChunks * tileChunks slots in row-major order; slots outside
+// the baked rectangle are null.
+void encodeArchiveTile(const TerrainArchiveHeader& header, const std::vector<const BakedChunk*>& chunks, std::vector<u8>& out);
+
+// Writes header, tile index and the encoded tiles (row-major over tiles). False on stream errors.
+[[nodiscard]] bool writeTerrainArchive(std::ostream& out, const TerrainArchiveHeader& header, const std::vector<std::vector<u8>>& tiles);
+
+// Reads an archive through a caller supplied random-access reader, so the runtime can go through
+// the engine's file API and tools through std streams. Main thread only.
+class TerrainArchive
+{
+
+public:
+    // Fills size bytes at offset into dst; false if the range could not be read completely.
+    using ReadFn = std::function<bool(u64 offset, u8* dst, size_t size)>;
+
+    explicit TerrainArchive(size_t tileCacheCapacity = 16);
+
+public:
+    // Reads header and tile index. False if the data is not a supported archive.
+    [[nodiscard]] bool open(ReadFn read);
+    void close() noexcept;
+
+    [[nodiscard]] bool isOpen() const noexcept;
+    [[nodiscard]] const TerrainArchiveHeader& header() const noexcept;
+
+    // Baked heightfield subsampled to lod, or null outside the rectangle or on corrupt data.
+    [[nodiscard]] std::shared_ptr<Heightfield> loadHeightfield(const ChunkCoord& coord, TerrainLevelOfDetail lod);
+
+    // Baked LOD0 mesh; false if the archive has no meshes or the chunk is missing.
+    [[nodiscard]] bool loadMesh(const ChunkCoord& coord, ChunkMeshData& out);
+
+    // Normalized min/max sample of a chunk, without decoding its heights.
+    [[nodiscard]] bool chunkBounds(const ChunkCoord& coord, f32& minSample, f32& maxSample);
+
+private:
+    struct TileEntry {
+        u64 offset = 0;
+        u32 size = 0;
+    };
+
+    // Compressed tile bytes and where each of its chunks starts; decoded per chunk on demand.
+    struct Tile {
+        std::vector<u8> bytes;
+        std::vector<u32> chunkOffsets; // into bytes, or emptyChunk
+        std::vector<f32> minSamples;
+        std::vector<f32> maxSamples;
+    };
+
+    struct ChunkRef {
+        const Tile *tile = nullptr;
+        size_t slot = 0;
+    };
+
+    [[nodiscard]] bool findChunk(const ChunkCoord& coord, ChunkRef& out);
+    [[nodiscard]] const Tile *loadTile(size_t index);
+
+private:
+    ReadFn read_;
+    TerrainArchiveHeader header_;
+    std::vector<TileEntry> index_;
+    bool open_ = false;
+
+    size_t tileCacheCapacity_;
+    std::list<size_t> tileLru_; // most recently used first
+    std::unordered_map<size_t, std::pair<Tile, std::list<size_t>::iterator>> tiles_;
+};
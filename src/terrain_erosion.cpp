@@ -0,0 +1,432 @@
+#include "terrain_erosion.h"
+#include "math_utils.h"
+#include "worker_pool.h"
+#include "random.h"
+#include "trace.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+struct HeightAndGradient {
+    f32 height;
+    f32 gx;
+    f32 gz;
+};
+
+[[nodiscard]] HeightAndGradient sampleHeightAndGradient(const std::vector<f32>& h, i32 n, f32 x, f32 z) noexcept {
+    const i32 ix = static_cast<i32>(x);
+    const i32 iz = static_cast<i32>(z);
+    const f32 fx = x - static_cast<f32>(ix);
+    const f32 fz = z - static_cast<f32>(iz);
+
+    const size_t i = static_cast<size_t>(iz) * n + ix;
+    const f32 h00 = h[i];
+    const f32 h10 = h[i + 1];
+    const f32 h01 = h[i + n];
+    const f32 h11 = h[i + n + 1];
+
+    HeightAndGradient r;
+    r.gx = (h10 - h00) * (1.0f - fz) + (h11 - h01) * fz;
+    r.gz = (h01 - h00) * (1.0f - fx) + (h11 - h10) * fx;
+    r.height = h00 * (1.0f - fx) * (1.0f - fz)
+             + h10 * fx * (1.0f - fz)
+             + h01 * (1.0f - fx) * fz
+             + h11 * fx * fz;
+    return r;
+}
+
+void runHydraulic(std::vector<f32>& h, i32 n, const ErosionSettings& s, SplitMix64& rng, i32 droplets) {
+    const f32 span = static_cast<f32>(n - 1);
+
+    for (i32 d = 0; d < droplets; d++) {
+        f32 x = rng.nextUnit() * span;
+        f32 z = rng.nextUnit() * span;
+        f32 dx = 0.0f;
+        f32 dz = 0.0f;
+        f32 speed = 1.0f;
+        f32 water = 1.0f;
+        f32 sediment = 0.0f;
+
+        for (i32 life = 0; life < s.droplet_lifetime; life++) {
+            const i32 ix = static_cast<i32>(x);
+            const i32 iz = static_cast<i32>(z);
+            const f32 fx = x - static_cast<f32>(ix);
+            const f32 fz = z - static_cast<f32>(iz);
+            const size_t cell = static_cast<size_t>(iz) * n + ix;
+
+            const HeightAndGradient hg = sampleHeightAndGradient(h, n, x, z);
+
+            dx = dx * s.inertia - hg.gx * (1.0f - s.inertia);
+            dz = dz * s.inertia - hg.gz * (1.0f - s.inertia);
+            const f32 len = std::sqrt(dx * dx + dz * dz);
+            if (len < 1e-6f) break;
+            dx /= len;
+            dz /= len;
+
+            x += dx;
+            z += dz;
+            if (x < 0.0f || z < 0.0f || x >= span || z >= span) break;
+
+            const f32 dh = sampleHeightAndGradient(h, n, x, z).height - hg.height;
+            const f32 capacity = std::max(-dh * speed * water * s.sediment_capacity, s.min_sediment_capacity);
+
+            if (sediment > capacity || dh > 0.0f) {
+                // Uphill: fill the pit we came from, otherwise drop the excess.
+                const f32 deposit = (dh > 0.0f) ? std::min(dh, sediment) : (sediment - capacity) * s.deposit_speed;
+                sediment -= deposit;
+                h[cell]         += deposit * (1.0f - fx) * (1.0f - fz);
+                h[cell + 1]     += deposit * fx * (1.0f - fz);
+                h[cell + n]     += deposit * (1.0f - fx) * fz;
+                h[cell + n + 1] += deposit * fx * fz;
+            } else {
+                const f32 erode = std::min((capacity - sediment) * s.erode_speed, -dh);
+                h[cell]         -= erode * (1.0f - fx) * (1.0f - fz);
+                h[cell + 1]     -= erode * fx * (1.0f - fz);
+                h[cell + n]     -= erode * (1.0f - fx) * fz;
+                h[cell + n + 1] -= erode * fx * fz;
+                sediment += erode;
+            }
+
+            speed = std::sqrt(std::max(0.0f, speed * speed - dh * s.gravity));
+            water *= (1.0f - s.evaporate_speed);
+        }
+    }
+}
+
+void runThermal(std::vector<f32>& h, i32 n, const ErosionSettings& s) {
+    std::vector<f32> delta(h.size());
+
+    auto settle = [&](size_t a, size_t b) {
+        const f32 diff = h[a] - h[b];
+        const f32 excess = std::abs(diff) - s.talus;
+        if (excess <= 0.0f) return;
+
+        const f32 moved = excess * s.thermal_rate * 0.5f;
+        const size_t from = diff > 0.0f ? a : b;
+        const size_t to = diff > 0.0f ? b : a;
+        delta[from] -= moved;
+        delta[to] += moved;
+    };
+
+    for (i32 it = 0; it < s.thermal_iterations; it++) {
+        std::fill(delta.begin(), delta.end(), 0.0f);
+
+        for (i32 z = 0; z < n; z++) {
+            for (i32 x = 0; x < n; x++) {
+                const size_t i = static_cast<size_t>(z) * n + x;
+                if (x + 1 < n) settle(i, i + 1);
+                if (z + 1 < n) settle(i, i + n);
+            }
+        }
+
+        for (size_t i = 0; i < h.size(); i++) {
+            h[i] += delta[i];
+        }
+    }
+}
+
+struct RegionLayout {
+    i32 core;
+    i32 overlap;
+    i32 band;
+};
+
+// The cross-fade stays well inside the overlap, clear of the droplets lost at its outer edge.
+[[nodiscard]] RegionLayout regionLayout(const ErosionSettings& settings, u16 chunkSize) noexcept {
+    RegionLayout layout;
+    layout.core = std::max(1, settings.region_chunks) * static_cast<i32>(chunkSize);
+    layout.overlap = std::max(0, settings.overlap);
+    layout.band = std::min(layout.overlap / 2, layout.core / 2);
+    return layout;
+}
+
+// Blend weight along one axis of a sample u core samples into a region. Goes from 1 inside to 0 over
+// [-band, band] around either border; a neighbour sees the mirrored ramp, so the two add up to one.
+[[nodiscard]] f32 regionAxisWeight(i64 u, i32 core, i32 band) noexcept {
+    if (band == 0) return (u >= 0 && u <= core) ? 1.0f : 0.0f; // shared border samples are averaged
+    if (u < band) return smoothstep(0.0f, 1.0f, static_cast<f32>(u + band) / static_cast<f32>(2 * band));
+    if (u > core - band) return smoothstep(0.0f, 1.0f, static_cast<f32>(core + band - u) / static_cast<f32>(2 * band));
+    return 1.0f;
+}
+
+} 
+
+std::shared_ptr<ErodedRegion> erodeRegion(
+    const NoiseGenerator& noise,
+    const ChunkCoord& region,
+    const ErosionSettings& settings,
+    u16 chunkSize,
+    f64 tileWidth,
+    f64 tileHeight,
+    i32 seed)
+{
+    TRACE_ZONE("erode region");
+
+    const RegionLayout layout = regionLayout(settings, chunkSize);
+    const i32 core = layout.core;
+    const i32 overlap = layout.overlap;
+    const i32 n = core + 1 + 2 * overlap;
+
+    // Work in tile units so slopes and the talus angle do not depend on tile_width/tile_height.
+    const f64 vertical = (tileWidth > 0.0) ? tileHeight / tileWidth : 1.0;
+    const f64 toGrid = (vertical != 0.0) ? vertical : 1.0;
+
+    const i64 origin_x = static_cast<i64>(region.x) * core - overlap;
+    const i64 origin_z = static_cast<i64>(region.z) * core - overlap;
+
+    std::vector<f32> raw(static_cast<size_t>(n) * n);
+    for (i32 z = 0; z < n; z++) {
+        const f64 world_z = static_cast<f64>(origin_z + z) * tileWidth;
+        for (i32 x = 0; x < n; x++) {
+            const f64 world_x = static_cast<f64>(origin_x + x) * tileWidth;
+            raw[static_cast<size_t>(z) * n + x] = static_cast<f32>(noise.getNoiseValue(world_x, world_z) * toGrid);
+        }
+    }
+
+    std::vector<f32> eroded = raw;
+
+    SplitMix64 rng(coordSeed(seed, region));
+    const f64 wanted = static_cast<f64>(settings.droplet_density) * static_cast<f64>(n) * static_cast<f64>(n);
+    const i32 droplets = static_cast<i32>(std::clamp(wanted, 0.0, static_cast<f64>(std::max(0, settings.max_droplets))));
+
+    runHydraulic(eroded, n, settings, rng, droplets);
+    runThermal(eroded, n, settings);
+
+    auto result = std::make_shared<ErodedRegion>();
+    result->region = region;
+    result->core = core;
+    result->overlap = overlap;
+    result->band = layout.band;
+    result->samplesPerSide = n;
+    result->samples.resize(raw.size());
+
+    const f32 strength = std::clamp(settings.strength, 0.0f, 1.0f);
+    for (size_t i = 0; i < raw.size(); i++) {
+        const f32 h = raw[i] + (eroded[i] - raw[i]) * strength;
+        result->samples[i] = static_cast<f32>(h / toGrid);
+    }
+
+    return result;
+}
+
+void erosionRegionsForChunk(const ChunkCoord& chunk, const ErosionSettings& settings, u16 chunkSize, std::vector<ChunkCoord>& out)
+{
+    const RegionLayout layout = regionLayout(settings, chunkSize);
+    const i32 region_chunks = std::max(1, settings.region_chunks);
+    const ChunkCoord region{ floorDiv(chunk.x, region_chunks), floorDiv(chunk.z, region_chunks) };
+
+    // Chunk extent in core samples of its own region
+    const i64 x0 = (chunk.x - region.x * region_chunks) * chunkSize;
+    const i64 z0 = (chunk.z - region.z * region_chunks) * chunkSize;
+    const i64 x1 = x0 + chunkSize;
+    const i64 z1 = z0 + chunkSize;
+
+    auto reaches = [&](i64 lo, i64 hi, i32 side) {
+        if (side < 0) return layout.band > 0 ? lo < layout.band : lo == 0;
+        if (side > 0) return layout.band > 0 ? hi > layout.core - layout.band : hi == layout.core;
+        return true;
+    };
+
+    out.clear();
+    for (i32 dz = -1; dz <= 1; dz++) {
+        if (!reaches(z0, z1, dz)) continue;
+        for (i32 dx = -1; dx <= 1; dx++) {
+            if (!reaches(x0, x1, dx)) continue;
+            out.push_back(ChunkCoord{ region.x + dx, region.z + dz });
+        }
+    }
+}
+
+std::shared_ptr<Heightfield> sampleHeightfieldFromRegions(
+    const std::vector<std::shared_ptr<const ErodedRegion>>& regions,
+    const ChunkCoord& coord,
+    TerrainLevelOfDetail lod,
+    u16 chunkSize)
+{
+    TRACE_ZONE("sample eroded heightfield");
+
+    auto heightfield = std::make_shared<Heightfield>();
+    heightfield->coord = coord;
+    heightfield->lod = lod;
+    heightfield->layout = chunkGridLayout(chunkSize, lod);
+    heightfield->eroded = true;
+
+    const i32 verts_per_side = heightfield->layout.vertsPerSide;
+    const i32 step = heightfield->layout.step;
+    const i64 gx0 = coord.x * chunkSize;
+    const i64 gz0 = coord.z * chunkSize;
+
+    heightfield->samples.resize(static_cast<size_t>(verts_per_side) * verts_per_side);
+
+    for (i32 vz = 0; vz < verts_per_side; vz++) {
+        const i64 gz = gz0 + vz * step;
+        for (i32 vx = 0; vx < verts_per_side; vx++) {
+            const i64 gx = gx0 + vx * step;
+
+            // Weighted mean in list order; a region outside its ramp adds nothing, so every chunk
+            // touching this sample sums the same terms in the same order.
+            f32 sum = 0.0f;
+            f32 weight_sum = 0.0f;
+            for (const std::shared_ptr<const ErodedRegion>& r : regions) {
+                const i64 ux = gx - r->region.x * r->core;
+                const i64 uz = gz - r->region.z * r->core;
+                const f32 w = regionAxisWeight(ux, r->core, r->band) * regionAxisWeight(uz, r->core, r->band);
+                if (w <= 0.0f) continue;
+
+                const size_t i = static_cast<size_t>(uz + r->overlap) * r->samplesPerSide + static_cast<size_t>(ux + r->overlap);
+                sum += w * r->samples[i];
+                weight_sum += w;
+            }
+            heightfield->samples[static_cast<size_t>(vz) * verts_per_side + vx] = weight_sum > 0.0f ? sum / weight_sum : 0.0f;
+        }
+    }
+
+    updateHeightfieldBounds(*heightfield);
+    return heightfield;
+}
+
+ErosionRegionCache::ErosionRegionCache()
+: state_(std::make_shared<SharedState>())
+{
+}
+
+void ErosionRegionCache::configure(const ErosionSettings& settings, u16 chunkSize, f64 tileWidth, f64 tileHeight, i32 seed)
+{
+    clear();
+    settings_ = settings;
+    settings_.region_chunks = std::max(1, settings_.region_chunks);
+    chunkSize_ = chunkSize;
+    tileWidth_ = tileWidth;
+    tileHeight_ = tileHeight;
+    seed_ = seed;
+}
+
+bool ErosionRegionCache::enabled() const noexcept
+{
+    return settings_.enabled && chunkSize_ > 0;
+}
+
+i32 ErosionRegionCache::regionChunks() const noexcept
+{
+    return settings_.region_chunks;
+}
+
+ChunkCoord ErosionRegionCache::regionForChunk(const ChunkCoord& chunk) const noexcept
+{
+    return ChunkCoord{
+        floorDiv(chunk.x, settings_.region_chunks),
+        floorDiv(chunk.z, settings_.region_chunks)
+    };
+}
+
+std::shared_ptr<const ErodedRegion> ErosionRegionCache::find(const ChunkCoord& region) const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    auto it = state_->ready.find(region);
+    return it != state_->ready.end() ? it->second : nullptr;
+}
+
+bool ErosionRegionCache::findForChunk(const ChunkCoord& chunk, std::vector<std::shared_ptr<const ErodedRegion>>& out) const
+{
+    std::vector<ChunkCoord> regions;
+    erosionRegionsForChunk(chunk, settings_, chunkSize_, regions);
+
+    out.clear();
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for (const ChunkCoord& region : regions) {
+        auto it = state_->ready.find(region);
+        if (it == state_->ready.end()) return false;
+        out.push_back(it->second);
+    }
+    return true;
+}
+
+bool ErosionRegionCache::readyForChunk(const ChunkCoord& chunk) const
+{
+    std::vector<std::shared_ptr<const ErodedRegion>> regions;
+    return findForChunk(chunk, regions);
+}
+
+void ErosionRegionCache::request(const ChunkCoord& region, std::shared_ptr<const NoiseGenerator> noise, WorkerPool& pool)
+{
+    if (!enabled() || pending_.count(region) > 0) return;
+    if (find(region)) return;
+
+    pending_.insert(region);
+
+    u64 generation;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        generation = state_->generation;
+    }
+
+    // The task keeps the shared state and its noise generator alive.
+    pool.submit([state = state_, generation, region, settings = settings_, noise = std::move(noise),
+                 chunkSize = chunkSize_, tileWidth = tileWidth_, tileHeight = tileHeight_, seed = seed_]() {
+        std::shared_ptr<const ErodedRegion> result =
+            erodeRegion(*noise, region, settings, chunkSize, tileWidth, tileHeight, seed);
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->generation != generation) return; // settings changed meanwhile
+        state->ready[region] = std::move(result);
+        state->completed.push_back(region);
+    });
+}
+
+void ErosionRegionCache::requestForChunk(const ChunkCoord& chunk, const std::shared_ptr<const NoiseGenerator>& noise, WorkerPool& pool)
+{
+    std::vector<ChunkCoord> regions;
+    erosionRegionsForChunk(chunk, settings_, chunkSize_, regions);
+    for (const ChunkCoord& region : regions) {
+        request(region, noise, pool);
+    }
+}
+
+void ErosionRegionCache::takeCompleted(std::vector<ChunkCoord>& out)
+{
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        out.insert(out.end(), state_->completed.begin(), state_->completed.end());
+        state_->completed.clear();
+    }
+
+    for (const ChunkCoord& region : out) {
+        pending_.erase(region);
+    }
+}
+
+void ErosionRegionCache::evictOutside(const std::vector<ChunkCoord>& centerRegions, i32 radius)
+{
+    auto reachable = [&](const ChunkCoord& region) {
+        for (const ChunkCoord& center : centerRegions) {
+            const i64 dx = std::abs(region.x - center.x);
+            const i64 dz = std::abs(region.z - center.z);
+            if (std::max(dx, dz) <= static_cast<i64>(radius)) return true;
+        }
+        return false;
+    };
+
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for (auto it = state_->ready.begin(); it != state_->ready.end(); ) {
+        if (!reachable(it->first)) {
+            it = state_->ready.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ErosionRegionCache::clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->generation++;
+        state_->ready.clear();
+        state_->completed.clear();
+    }
+    pending_.clear();
+}
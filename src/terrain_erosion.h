@@ -0,0 +1,126 @@
+#pragma once
+
+#include "heightfield.h"
+
+// std
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class WorkerPool;
+
+struct ErosionSettings
+{
+    bool enabled = false;
+
+    // Region layout
+    i32 region_chunks = 4; // region side length in chunks
+    i32 overlap = 16;      // samples eroded around the region; the inner half cross-fades with neighbours
+
+    // Hydraulic (droplets)
+    f32 droplet_density = 0.25f; // droplets per LOD0 sample
+    i32 max_droplets = 40000;    // hard per-region cost cap
+    i32 droplet_lifetime = 30;
+    f32 inertia = 0.05f;
+    f32 sediment_capacity = 4.0f;
+    f32 min_sediment_capacity = 0.01f;
+    f32 erode_speed = 0.3f;
+    f32 deposit_speed = 0.3f;
+    f32 evaporate_speed = 0.02f;
+    f32 gravity = 4.0f;
+
+    // Thermal
+    i32 thermal_iterations = 8;
+    f32 talus = 0.7f; // stable slope (rise over run) before material slides
+    f32 thermal_rate = 0.5f;
+
+    f32 strength = 1.0f; // 0 = raw noise, 1 = fully eroded
+};
+
+// LOD0 samples of one eroded region and the overlap around it, strength already applied.
+struct ErodedRegion
+{
+    ChunkCoord region{0, 0};
+    i32 core = 0;           // region_chunks * chunkSize
+    i32 overlap = 0;        // samples eroded on every side of the core
+    i32 band = 0;           // half width of the cross-fade across each region border
+    i32 samplesPerSide = 0; // core + 1 + 2 * overlap
+    std::vector<f32> samples;
+};
+
+// Erodes a region and its overlap deterministically: the result only depends on the region, the noise
+// and the settings.
+[[nodiscard]] std::shared_ptr<ErodedRegion> erodeRegion(
+    const NoiseGenerator& noise,
+    const ChunkCoord& region,
+    const ErosionSettings& settings,
+    u16 chunkSize,
+    f64 tileWidth,
+    f64 tileHeight,
+    i32 seed);
+
+// Regions a chunk's eroded heights are blended from, in the order the blend sums them: its own region
+// plus every neighbour across a region border the chunk reaches into the cross-fade band of.
+void erosionRegionsForChunk(const ChunkCoord& chunk, const ErosionSettings& settings, u16 chunkSize, std::vector<ChunkCoord>& out);
+
+// Chunk heights from the regions erosionRegionsForChunk lists, in that order. Within the band around a
+// region border the eroded results of the regions on both sides are cross-faded with weights summing to
+// one, so borders keep their erosion and chunks on either side compute the same shared samples.
+[[nodiscard]] std::shared_ptr<Heightfield> sampleHeightfieldFromRegions(
+    const std::vector<std::shared_ptr<const ErodedRegion>>& regions,
+    const ChunkCoord& coord,
+    TerrainLevelOfDetail lod,
+    u16 chunkSize);
+
+// Tracks which regions are eroded or being eroded on the worker pool.
+// Everything except the worker tasks themselves runs on the main thread.
+class ErosionRegionCache
+{
+
+public:
+    ErosionRegionCache();
+
+public:
+    void configure(const ErosionSettings& settings, u16 chunkSize, f64 tileWidth, f64 tileHeight, i32 seed);
+    [[nodiscard]] bool enabled() const noexcept;
+    [[nodiscard]] i32 regionChunks() const noexcept;
+
+    [[nodiscard]] ChunkCoord regionForChunk(const ChunkCoord& chunk) const noexcept;
+    [[nodiscard]] std::shared_ptr<const ErodedRegion> find(const ChunkCoord& region) const;
+
+    // Every region the chunk blends from, in erosionRegionsForChunk order; false while one is missing.
+    [[nodiscard]] bool findForChunk(const ChunkCoord& chunk, std::vector<std::shared_ptr<const ErodedRegion>>& out) const;
+    [[nodiscard]] bool readyForChunk(const ChunkCoord& chunk) const;
+
+    // Schedules erosion of the region unless it is ready or already queued. The task holds on to noise,
+    // so the caller may replace its generator while the task still runs.
+    void request(const ChunkCoord& region, std::shared_ptr<const NoiseGenerator> noise, WorkerPool& pool);
+    void requestForChunk(const ChunkCoord& chunk, const std::shared_ptr<const NoiseGenerator>& noise, WorkerPool& pool);
+
+    // Regions finished since the last call.
+    void takeCompleted(std::vector<ChunkCoord>& out);
+
+    // Drops ready regions further than radius from every one of the given regions.
+    void evictOutside(const std::vector<ChunkCoord>& centerRegions, i32 radius);
+    void clear();
+
+private:
+    struct SharedState {
+        std::mutex mutex;
+        std::unordered_map<ChunkCoord, std::shared_ptr<const ErodedRegion>, ChunkCoordHash> ready;
+        std::vector<ChunkCoord> completed;
+        u64 generation = 0;
+    };
+
+private:
+    ErosionSettings settings_;
+    u16 chunkSize_ = 32;
+    f64 tileWidth_ = 1.0;
+    f64 tileHeight_ = 1.0;
+    i32 seed_ = 0;
+
+    std::shared_ptr<SharedState> state_;
+    std::unordered_set<ChunkCoord, ChunkCoordHash> pending_;
+};
@@ -1,11 +1,22 @@
 #include "terrain_generator.h"
+#include "scratch_arena.h"
+#include "trace.h"
 
 // Godot
 #include "godot_cpp/core/class_db.hpp"
 #include "godot_cpp/classes/array_mesh.hpp"
+#include "godot_cpp/classes/multi_mesh.hpp"
+#include "godot_cpp/classes/file_access.hpp"
+#include "godot_cpp/classes/project_settings.hpp"
 #include "godot_cpp/variant/packed_vector3_array.hpp"
 #include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/variant/packed_vector2_array.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include "godot_cpp/variant/packed_float32_array.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/typed_array.hpp"
 #include "godot_cpp/variant/array.hpp"
+#include "godot_cpp/variant/aabb.hpp"
 
 // std
 #include <algorithm>
@@ -20,10 +31,11 @@ namespace
 constexpr f64 defaultTileWith = 1.0;
 constexpr u16 defaultChunkSize = 32;
 constexpr f64 defaultTileHeight = 10.0;
+constexpr size_t maxPooledScatterNodes = 64;
+
+// Fraction of a chunk side an eye may move before the horizon pass runs again.
+constexpr f64 occlusionEyeTolerance = 0.125;
 
-[[nodiscard]] int chebyshevDist(int dx, int dz) {
-    return std::max(std::abs(dx), std::abs(dz));
-}
 
 } 
 
@@ -56,6 +68,72 @@ void TerrainGenerator::_bind_methods()
     ClassDB::bind_method(D_METHOD("get_domain_warp_amplitude"), &TerrainGenerator::get_domain_warp_amplitude);
     ClassDB::bind_method(D_METHOD("set_domain_warp_amplitude", "v"), &TerrainGenerator::set_domain_warp_amplitude);
 
+    ClassDB::bind_method(D_METHOD("get_erosion_enabled"), &TerrainGenerator::get_erosion_enabled);
+    ClassDB::bind_method(D_METHOD("set_erosion_enabled", "v"), &TerrainGenerator::set_erosion_enabled);
+
+    ClassDB::bind_method(D_METHOD("get_erosion_region_chunks"), &TerrainGenerator::get_erosion_region_chunks);
+    ClassDB::bind_method(D_METHOD("set_erosion_region_chunks", "v"), &TerrainGenerator::set_erosion_region_chunks);
+
+    ClassDB::bind_method(D_METHOD("get_erosion_overlap"), &TerrainGenerator::get_erosion_overlap);
+    ClassDB::bind_method(D_METHOD("set_erosion_overlap", "v"), &TerrainGenerator::set_erosion_overlap);
+
+    ClassDB::bind_method(D_METHOD("get_erosion_droplet_density"), &TerrainGenerator::get_erosion_droplet_density);
+    ClassDB::bind_method(D_METHOD("set_erosion_droplet_density", "v"), &TerrainGenerator::set_erosion_droplet_density);
+
+    ClassDB::bind_method(D_METHOD("get_erosion_max_droplets"), &TerrainGenerator::get_erosion_max_droplets);
+    ClassDB::bind_method(D_METHOD("set_erosion_max_droplets", "v"), &TerrainGenerator::set_erosion_max_droplets);
+
+    ClassDB::bind_method(D_METHOD("get_erosion_thermal_iterations"), &TerrainGenerator::get_erosion_thermal_iterations);
+    ClassDB::bind_method(D_METHOD("set_erosion_thermal_iterations", "v"), &TerrainGenerator::set_erosion_thermal_iterations);
+
+    ClassDB::bind_method(D_METHOD("get_erosion_strength"), &TerrainGenerator::get_erosion_strength);
+    ClassDB::bind_method(D_METHOD("set_erosion_strength", "v"), &TerrainGenerator::set_erosion_strength);
+
+    ClassDB::bind_method(D_METHOD("get_splat_weights_enabled"), &TerrainGenerator::get_splat_weights_enabled);
+    ClassDB::bind_method(D_METHOD("set_splat_weights_enabled", "v"), &TerrainGenerator::set_splat_weights_enabled);
+
+    ClassDB::bind_method(D_METHOD("get_splat_sand_height"), &TerrainGenerator::get_splat_sand_height);
+    ClassDB::bind_method(D_METHOD("set_splat_sand_height", "v"), &TerrainGenerator::set_splat_sand_height);
+
+    ClassDB::bind_method(D_METHOD("get_splat_snow_height"), &TerrainGenerator::get_splat_snow_height);
+    ClassDB::bind_method(D_METHOD("set_splat_snow_height", "v"), &TerrainGenerator::set_splat_snow_height);
+
+    ClassDB::bind_method(D_METHOD("get_splat_rock_slope"), &TerrainGenerator::get_splat_rock_slope);
+    ClassDB::bind_method(D_METHOD("set_splat_rock_slope", "v"), &TerrainGenerator::set_splat_rock_slope);
+
+    ClassDB::bind_method(D_METHOD("get_splat_blend"), &TerrainGenerator::get_splat_blend);
+    ClassDB::bind_method(D_METHOD("set_splat_blend", "v"), &TerrainGenerator::set_splat_blend);
+
+    ClassDB::bind_method(D_METHOD("get_splat_biome_frequency"), &TerrainGenerator::get_splat_biome_frequency);
+    ClassDB::bind_method(D_METHOD("set_splat_biome_frequency", "v"), &TerrainGenerator::set_splat_biome_frequency);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_enabled"), &TerrainGenerator::get_scatter_enabled);
+    ClassDB::bind_method(D_METHOD("set_scatter_enabled", "v"), &TerrainGenerator::set_scatter_enabled);
+
+    ClassDB::bind_method(D_METHOD("set_scatter_mesh", "mesh"), &TerrainGenerator::set_scatter_mesh);
+    ClassDB::bind_method(D_METHOD("get_scatter_mesh"), &TerrainGenerator::get_scatter_mesh);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_density"), &TerrainGenerator::get_scatter_density);
+    ClassDB::bind_method(D_METHOD("set_scatter_density", "v"), &TerrainGenerator::set_scatter_density);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_max_lod"), &TerrainGenerator::get_scatter_max_lod);
+    ClassDB::bind_method(D_METHOD("set_scatter_max_lod", "v"), &TerrainGenerator::set_scatter_max_lod);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_lod_falloff"), &TerrainGenerator::get_scatter_lod_falloff);
+    ClassDB::bind_method(D_METHOD("set_scatter_lod_falloff", "v"), &TerrainGenerator::set_scatter_lod_falloff);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_max_slope"), &TerrainGenerator::get_scatter_max_slope);
+    ClassDB::bind_method(D_METHOD("set_scatter_max_slope", "v"), &TerrainGenerator::set_scatter_max_slope);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_min_scale"), &TerrainGenerator::get_scatter_min_scale);
+    ClassDB::bind_method(D_METHOD("set_scatter_min_scale", "v"), &TerrainGenerator::set_scatter_min_scale);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_max_scale"), &TerrainGenerator::get_scatter_max_scale);
+    ClassDB::bind_method(D_METHOD("set_scatter_max_scale", "v"), &TerrainGenerator::set_scatter_max_scale);
+
+    ClassDB::bind_method(D_METHOD("get_scatter_density_frequency"), &TerrainGenerator::get_scatter_density_frequency);
+    ClassDB::bind_method(D_METHOD("set_scatter_density_frequency", "v"), &TerrainGenerator::set_scatter_density_frequency);
+
     ClassDB::bind_method(D_METHOD("get_tile_width"), &TerrainGenerator::get_tile_width);
     ClassDB::bind_method(D_METHOD("set_tile_width", "width"), &TerrainGenerator::set_tile_width);
 
@@ -68,9 +146,15 @@ void TerrainGenerator::_bind_methods()
     ClassDB::bind_method(D_METHOD("set_player_node", "path"), &TerrainGenerator::set_player_node);
     ClassDB::bind_method(D_METHOD("get_player_node"), &TerrainGenerator::get_player_node);
 
+    ClassDB::bind_method(D_METHOD("set_viewer_nodes", "paths"), &TerrainGenerator::set_viewer_nodes);
+    ClassDB::bind_method(D_METHOD("get_viewer_nodes"), &TerrainGenerator::get_viewer_nodes);
+
     ClassDB::bind_method(D_METHOD("set_terrain_material", "material"), &TerrainGenerator::set_terrain_material);
     ClassDB::bind_method(D_METHOD("get_terrain_material"), &TerrainGenerator::get_terrain_material);
 
+    ClassDB::bind_method(D_METHOD("set_baked_archive", "path"), &TerrainGenerator::set_baked_archive);
+    ClassDB::bind_method(D_METHOD("get_baked_archive"), &TerrainGenerator::get_baked_archive);
+
     ClassDB::bind_method(D_METHOD("set_view_radius", "radius"), &TerrainGenerator::set_view_radius);
     ClassDB::bind_method(D_METHOD("get_view_radius"), &TerrainGenerator::get_view_radius);
 
@@ -80,6 +164,11 @@ void TerrainGenerator::_bind_methods()
     ClassDB::bind_method(D_METHOD("set_chunks_per_frame", "count"), &TerrainGenerator::set_chunks_per_frame);
     ClassDB::bind_method(D_METHOD("get_chunks_per_frame"), &TerrainGenerator::get_chunks_per_frame);
 
+    ClassDB::bind_method(D_METHOD("set_heightfield_only", "enabled"), &TerrainGenerator::set_heightfield_only);
+    ClassDB::bind_method(D_METHOD("get_heightfield_only"), &TerrainGenerator::get_heightfield_only);
+
+    ClassDB::bind_method(D_METHOD("get_height_at", "position"), &TerrainGenerator::get_height_at);
+
     ClassDB::bind_method(D_METHOD("set_lod_level_0_distance", "distance"), &TerrainGenerator::set_lod_level_0_distance);
     ClassDB::bind_method(D_METHOD("get_lod_level_0_distance"), &TerrainGenerator::get_lod_level_0_distance);
 
@@ -89,9 +178,43 @@ void TerrainGenerator::_bind_methods()
     ClassDB::bind_method(D_METHOD("set_lod_level_2_distance", "distance"), &TerrainGenerator::set_lod_level_2_distance);
     ClassDB::bind_method(D_METHOD("get_lod_level_2_distance"), &TerrainGenerator::get_lod_level_2_distance);
 
+    ClassDB::bind_method(D_METHOD("set_lod_hysteresis", "chunks"), &TerrainGenerator::set_lod_hysteresis);
+    ClassDB::bind_method(D_METHOD("get_lod_hysteresis"), &TerrainGenerator::get_lod_hysteresis);
+
+    ClassDB::bind_method(D_METHOD("set_lod_morph_enabled", "enabled"), &TerrainGenerator::set_lod_morph_enabled);
+    ClassDB::bind_method(D_METHOD("get_lod_morph_enabled"), &TerrainGenerator::get_lod_morph_enabled);
+
+    ClassDB::bind_method(D_METHOD("set_lod_morph_range", "chunks"), &TerrainGenerator::set_lod_morph_range);
+    ClassDB::bind_method(D_METHOD("get_lod_morph_range"), &TerrainGenerator::get_lod_morph_range);
+
     ClassDB::bind_method(D_METHOD("set_water_level", "level"), &TerrainGenerator::set_water_level);
     ClassDB::bind_method(D_METHOD("get_water_level"), &TerrainGenerator::get_water_level);
 
+    ClassDB::bind_method(D_METHOD("set_mesh_simplification_enabled", "enabled"), &TerrainGenerator::set_mesh_simplification_enabled);
+    ClassDB::bind_method(D_METHOD("get_mesh_simplification_enabled"), &TerrainGenerator::get_mesh_simplification_enabled);
+
+    ClassDB::bind_method(D_METHOD("set_mesh_simplification_error", "error"), &TerrainGenerator::set_mesh_simplification_error);
+    ClassDB::bind_method(D_METHOD("get_mesh_simplification_error"), &TerrainGenerator::get_mesh_simplification_error);
+
+    ClassDB::bind_method(D_METHOD("set_floating_origin_enabled", "enabled"), &TerrainGenerator::set_floating_origin_enabled);
+    ClassDB::bind_method(D_METHOD("get_floating_origin_enabled"), &TerrainGenerator::get_floating_origin_enabled);
+
+    ClassDB::bind_method(D_METHOD("set_floating_origin_threshold", "threshold"), &TerrainGenerator::set_floating_origin_threshold);
+    ClassDB::bind_method(D_METHOD("get_floating_origin_threshold"), &TerrainGenerator::get_floating_origin_threshold);
+
+    ClassDB::bind_method(D_METHOD("set_horizon_occlusion_enabled", "enabled"), &TerrainGenerator::set_horizon_occlusion_enabled);
+    ClassDB::bind_method(D_METHOD("get_horizon_occlusion_enabled"), &TerrainGenerator::get_horizon_occlusion_enabled);
+
+    ClassDB::bind_method(D_METHOD("set_horizon_occlusion_margin", "margin"), &TerrainGenerator::set_horizon_occlusion_margin);
+    ClassDB::bind_method(D_METHOD("get_horizon_occlusion_margin"), &TerrainGenerator::get_horizon_occlusion_margin);
+
+    ClassDB::bind_method(D_METHOD("get_origin_chunk_x"), &TerrainGenerator::get_origin_chunk_x);
+    ClassDB::bind_method(D_METHOD("get_origin_chunk_z"), &TerrainGenerator::get_origin_chunk_z);
+
+    ClassDB::bind_method(D_METHOD("get_generation_stats"), &TerrainGenerator::get_generation_stats);
+    ClassDB::bind_method(D_METHOD("reset_generation_stats"), &TerrainGenerator::reset_generation_stats);
+    ClassDB::bind_method(D_METHOD("save_trace", "path"), &TerrainGenerator::save_trace);
+
 
     ADD_GROUP("Noise", "");
 
@@ -136,6 +259,113 @@ void TerrainGenerator::_bind_methods()
         "0.0,200.0,0.1"
     ), "set_domain_warp_amplitude", "get_domain_warp_amplitude");
 
+    ADD_GROUP("Erosion", "");
+
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "erosion_enabled"), "set_erosion_enabled", "get_erosion_enabled");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::INT, "erosion_region_chunks", PROPERTY_HINT_RANGE,
+        "1,16,1"
+    ), "set_erosion_region_chunks", "get_erosion_region_chunks");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::INT, "erosion_overlap", PROPERTY_HINT_RANGE,
+        "0,128,1"
+    ), "set_erosion_overlap", "get_erosion_overlap");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "erosion_droplet_density", PROPERTY_HINT_RANGE,
+        "0.0,4.0,0.01"
+    ), "set_erosion_droplet_density", "get_erosion_droplet_density");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::INT, "erosion_max_droplets", PROPERTY_HINT_RANGE,
+        "0,1000000,1"
+    ), "set_erosion_max_droplets", "get_erosion_max_droplets");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::INT, "erosion_thermal_iterations", PROPERTY_HINT_RANGE,
+        "0,100,1"
+    ), "set_erosion_thermal_iterations", "get_erosion_thermal_iterations");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "erosion_strength", PROPERTY_HINT_RANGE,
+        "0.0,1.0,0.01"
+    ), "set_erosion_strength", "get_erosion_strength");
+
+    ADD_GROUP("Splat Weights", "");
+
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "splat_weights_enabled"), "set_splat_weights_enabled", "get_splat_weights_enabled");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "splat_sand_height", PROPERTY_HINT_RANGE,
+        "0.0,1.0,0.001"
+    ), "set_splat_sand_height", "get_splat_sand_height");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "splat_snow_height", PROPERTY_HINT_RANGE,
+        "0.0,1.0,0.001"
+    ), "set_splat_snow_height", "get_splat_snow_height");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "splat_rock_slope", PROPERTY_HINT_RANGE,
+        "0.0,1.0,0.001"
+    ), "set_splat_rock_slope", "get_splat_rock_slope");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "splat_blend", PROPERTY_HINT_RANGE,
+        "0.0,0.5,0.001"
+    ), "set_splat_blend", "get_splat_blend");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "splat_biome_frequency", PROPERTY_HINT_RANGE,
+        "0.0,0.1,0.0001"
+    ), "set_splat_biome_frequency", "get_splat_biome_frequency");
+
+    ADD_GROUP("Scatter", "");
+
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "scatter_enabled"), "set_scatter_enabled", "get_scatter_enabled");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::OBJECT, "scatter_mesh", PROPERTY_HINT_RESOURCE_TYPE,
+        "Mesh"
+    ), "set_scatter_mesh", "get_scatter_mesh");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "scatter_density", PROPERTY_HINT_RANGE,
+        "0.0,16.0,0.01"
+    ), "set_scatter_density", "get_scatter_density");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::INT, "scatter_max_lod", PROPERTY_HINT_RANGE,
+        "0,3,1"
+    ), "set_scatter_max_lod", "get_scatter_max_lod");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "scatter_lod_falloff", PROPERTY_HINT_RANGE,
+        "0.0,1.0,0.01"
+    ), "set_scatter_lod_falloff", "get_scatter_lod_falloff");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "scatter_max_slope", PROPERTY_HINT_RANGE,
+        "0.0,1.0,0.01"
+    ), "set_scatter_max_slope", "get_scatter_max_slope");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "scatter_min_scale", PROPERTY_HINT_RANGE,
+        "0.01,10.0,0.01"
+    ), "set_scatter_min_scale", "get_scatter_min_scale");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "scatter_max_scale", PROPERTY_HINT_RANGE,
+        "0.01,10.0,0.01"
+    ), "set_scatter_max_scale", "get_scatter_max_scale");
+
+    ADD_PROPERTY(PropertyInfo(
+        Variant::FLOAT, "scatter_density_frequency", PROPERTY_HINT_RANGE,
+        "0.0,0.1,0.0001"
+    ), "set_scatter_density_frequency", "get_scatter_density_frequency");
+
     ADD_GROUP("Generation", "");
 
     ADD_PROPERTY(
@@ -156,6 +386,12 @@ void TerrainGenerator::_bind_methods()
         "get_chunks_per_frame"
     );
 
+    ADD_PROPERTY(
+        PropertyInfo(Variant::BOOL, "heightfield_only"),
+        "set_heightfield_only",
+        "get_heightfield_only"
+    );
+
     ADD_SUBGROUP("LOD Distances", "");
 
     ADD_PROPERTY(
@@ -176,6 +412,69 @@ void TerrainGenerator::_bind_methods()
         "get_lod_level_2_distance"
     );
 
+    ADD_PROPERTY(
+        PropertyInfo(Variant::INT, "lod_hysteresis", PROPERTY_HINT_RANGE, "0,10,1"),
+        "set_lod_hysteresis",
+        "get_lod_hysteresis"
+    );
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::BOOL, "lod_morph_enabled"),
+        "set_lod_morph_enabled",
+        "get_lod_morph_enabled"
+    );
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::FLOAT, "lod_morph_range", PROPERTY_HINT_RANGE, "0.05,4.0,0.05"),
+        "set_lod_morph_range",
+        "get_lod_morph_range"
+    );
+
+    ADD_SUBGROUP("Simplification", "");
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::BOOL, "mesh_simplification_enabled"),
+        "set_mesh_simplification_enabled",
+        "get_mesh_simplification_enabled"
+    );
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::FLOAT, "mesh_simplification_error", PROPERTY_HINT_RANGE, "0.0,10.0,0.001,or_greater"),
+        "set_mesh_simplification_error",
+        "get_mesh_simplification_error"
+    );
+
+    ADD_SUBGROUP("Floating Origin", "");
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::BOOL, "floating_origin_enabled"),
+        "set_floating_origin_enabled",
+        "get_floating_origin_enabled"
+    );
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::FLOAT, "floating_origin_threshold", PROPERTY_HINT_RANGE, "16.0,100000.0,1.0,or_greater"),
+        "set_floating_origin_threshold",
+        "get_floating_origin_threshold"
+    );
+
+    ADD_SUBGROUP("Horizon Occlusion", "");
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::BOOL, "horizon_occlusion_enabled"),
+        "set_horizon_occlusion_enabled",
+        "get_horizon_occlusion_enabled"
+    );
+
+    ADD_PROPERTY(
+        PropertyInfo(Variant::FLOAT, "horizon_occlusion_margin", PROPERTY_HINT_RANGE, "0.0,100.0,0.1,or_greater"),
+        "set_horizon_occlusion_margin",
+        "get_horizon_occlusion_margin"
+    );
+
+    // Emitted after the world moved by offset; shift anything else positioned in world space by it.
+    ADD_SIGNAL(MethodInfo("origin_shifted", PropertyInfo(Variant::VECTOR3, "offset")));
+
     ADD_GROUP("Terrain", "");
 
     ADD_PROPERTY(
@@ -184,6 +483,12 @@ void TerrainGenerator::_bind_methods()
     "get_player_node"
     );
 
+    ADD_PROPERTY(
+    PropertyInfo(Variant::ARRAY, "viewer_nodes", PROPERTY_HINT_ARRAY_TYPE, "NodePath"),
+    "set_viewer_nodes",
+    "get_viewer_nodes"
+    );
+
     ADD_PROPERTY(
     PropertyInfo(
         Variant::OBJECT,
@@ -195,6 +500,12 @@ void TerrainGenerator::_bind_methods()
     "get_terrain_material"
     );
 
+    ADD_PROPERTY(
+        PropertyInfo(Variant::STRING, "baked_archive", PROPERTY_HINT_FILE, "*.tgar"),
+        "set_baked_archive",
+        "get_baked_archive"
+    );
+
     ADD_PROPERTY(
         PropertyInfo(Variant::FLOAT, "tile_width", PROPERTY_HINT_RANGE, "0.0,1000.0,0.01,or_greater"),
         "set_tile_width",
@@ -221,13 +532,21 @@ void TerrainGenerator::_bind_methods()
 }
 
 TerrainGenerator::TerrainGenerator()
-: noiseGenerator_(std::make_unique<NoiseGenerator>())
+: noiseGenerator_(std::make_shared<NoiseGenerator>())
 , tileWidth_(defaultTileWith)
 , chunkSize_(defaultChunkSize)
 , tileHeight_(defaultTileHeight)
 {
 }
 
+TerrainGenerator::~TerrainGenerator()
+{
+    // Pooled scatter nodes are outside the tree, nothing else frees them.
+    for (MultiMeshInstance3D *scatter : scatterPool_) {
+        memdelete(scatter);
+    }
+}
+
 f64 TerrainGenerator::get_tile_width() const noexcept {
     return tileWidth_;
 }
@@ -258,13 +577,23 @@ void TerrainGenerator::set_tile_height(f64 height) noexcept {
 void TerrainGenerator::set_player_node(const NodePath &path) 
 {
     player_path_ = path;
-    resolvePlayerNode();
+    resolveViewerNodes();
 }
 
 NodePath TerrainGenerator::get_player_node() const {
     return player_path_;
 }
 
+void TerrainGenerator::set_viewer_nodes(const TypedArray<NodePath> &paths)
+{
+    viewer_paths_ = paths;
+    resolveViewerNodes();
+}
+
+TypedArray<NodePath> TerrainGenerator::get_viewer_nodes() const {
+    return viewer_paths_;
+}
+
 void TerrainGenerator::set_terrain_material(const Ref<Material> &material) {
     terrain_material_ = material;
 }
@@ -273,6 +602,14 @@ Ref<Material> TerrainGenerator::get_terrain_material() const {
     return terrain_material_;
 }
 
+void TerrainGenerator::set_baked_archive(const String &path) {
+    baked_archive_path_ = path;
+}
+
+String TerrainGenerator::get_baked_archive() const {
+    return baked_archive_path_;
+}
+
 void TerrainGenerator::set_view_radius(i32 radius) noexcept {
     if (radius < 0) radius = 0;
     viewRadius_ = radius;
@@ -300,6 +637,42 @@ i32 TerrainGenerator::get_chunks_per_frame() const noexcept {
     return chunksPerFrame_;
 }
 
+void TerrainGenerator::set_heightfield_only(bool enabled) noexcept {
+    heightfieldOnly_ = enabled;
+}
+
+bool TerrainGenerator::get_heightfield_only() const noexcept {
+    return heightfieldOnly_;
+}
+
+f64 TerrainGenerator::get_height_at(const Vector3 &position) const
+{
+    const f64 s = (f64)chunkSize_ * tileWidth_;
+    if (s <= 0.0) return 0.0;
+
+    const ChunkCoord coord = chunkFromWorld(position);
+
+    auto it = chunks_.find(coord);
+    if (it != chunks_.end() && it->second.heightfield) {
+        // Same surface the chunk mesh shows, at the LOD it was built with.
+        const Heightfield &heightfield = *it->second.heightfield;
+        const f64 quad_size = tileWidth_ * static_cast<f64>(heightfield.layout.step);
+        const f64 local_x = position.x - static_cast<f64>(coord.x - originChunk_.x) * s;
+        const f64 local_z = position.z - static_cast<f64>(coord.z - originChunk_.z) * s;
+
+        const f32 h = interpolateHeightfield(heightfield,
+                                             static_cast<f32>(local_x / quad_size),
+                                             static_cast<f32>(local_z / quad_size),
+                                             static_cast<f32>(waterLevel_));
+        return static_cast<f64>(h) * tileHeight_;
+    }
+
+    // Not streamed in: raw noise at the point, erosion is not applied.
+    const f64 world_x = static_cast<f64>(originChunk_.x) * s + position.x;
+    const f64 world_z = static_cast<f64>(originChunk_.z) * s + position.z;
+    return std::max(noiseGenerator_->getNoiseValue(world_x, world_z), waterLevel_) * tileHeight_;
+}
+
 void TerrainGenerator::set_lod_level_0_distance(i32 distance) noexcept {
     if (distance < 0) distance = 0;
     lodLevel0Distance_ = distance;
@@ -327,6 +700,31 @@ i32 TerrainGenerator::get_lod_level_2_distance() const noexcept {
     return lodLevel2Distance_;
 }
 
+void TerrainGenerator::set_lod_hysteresis(i32 chunks) noexcept {
+    if (chunks < 0) chunks = 0;
+    lodHysteresis_ = chunks;
+}
+
+i32 TerrainGenerator::get_lod_hysteresis() const noexcept {
+    return lodHysteresis_;
+}
+
+void TerrainGenerator::set_lod_morph_enabled(bool enabled) noexcept {
+    lodMorph_ = enabled;
+}
+
+bool TerrainGenerator::get_lod_morph_enabled() const noexcept {
+    return lodMorph_;
+}
+
+void TerrainGenerator::set_lod_morph_range(f64 chunks) noexcept {
+    lodMorphRange_ = std::clamp(chunks, 0.05, 4.0);
+}
+
+f64 TerrainGenerator::get_lod_morph_range() const noexcept {
+    return lodMorphRange_;
+}
+
 void TerrainGenerator::set_water_level(f64 level) noexcept {
     waterLevel_ = level;
 }
@@ -335,6 +733,106 @@ f64 TerrainGenerator::get_water_level() const noexcept {
     return waterLevel_;
 }
 
+void TerrainGenerator::set_mesh_simplification_enabled(bool enabled) noexcept {
+    simplifyMesh_ = enabled;
+}
+
+bool TerrainGenerator::get_mesh_simplification_enabled() const noexcept {
+    return simplifyMesh_;
+}
+
+void TerrainGenerator::set_mesh_simplification_error(f64 error) noexcept {
+    if (error < 0.0) error = 0.0;
+    simplifyError_ = error;
+}
+
+f64 TerrainGenerator::get_mesh_simplification_error() const noexcept {
+    return simplifyError_;
+}
+
+void TerrainGenerator::set_floating_origin_enabled(bool enabled) noexcept {
+    floatingOrigin_ = enabled;
+}
+
+bool TerrainGenerator::get_floating_origin_enabled() const noexcept {
+    return floatingOrigin_;
+}
+
+void TerrainGenerator::set_floating_origin_threshold(f64 threshold) noexcept {
+    if (threshold < 1.0) threshold = 1.0;
+    floatingOriginThreshold_ = threshold;
+}
+
+f64 TerrainGenerator::get_floating_origin_threshold() const noexcept {
+    return floatingOriginThreshold_;
+}
+
+void TerrainGenerator::set_horizon_occlusion_enabled(bool enabled) noexcept {
+    horizonOcclusion_ = enabled;
+    occlusionDirty_ = true;
+}
+
+bool TerrainGenerator::get_horizon_occlusion_enabled() const noexcept {
+    return horizonOcclusion_;
+}
+
+void TerrainGenerator::set_horizon_occlusion_margin(f64 margin) noexcept {
+    if (margin < 0.0) margin = 0.0;
+    horizonOcclusionMargin_ = margin;
+    occlusionDirty_ = true;
+}
+
+f64 TerrainGenerator::get_horizon_occlusion_margin() const noexcept {
+    return horizonOcclusionMargin_;
+}
+
+i64 TerrainGenerator::get_origin_chunk_x() const noexcept {
+    return originChunk_.x;
+}
+
+i64 TerrainGenerator::get_origin_chunk_z() const noexcept {
+    return originChunk_.z;
+}
+
+Dictionary TerrainGenerator::get_generation_stats() const {
+    Dictionary stats;
+    stats["chunks_built"] = static_cast<int64_t>(stats_.chunksBuilt);
+    stats["triangles_emitted"] = static_cast<int64_t>(stats_.trianglesEmitted);
+    stats["triangles_uniform"] = static_cast<int64_t>(stats_.trianglesUniform);
+    stats["chunks_occluded"] = static_cast<int64_t>(stats_.chunksOccluded);
+    stats["lod_rebuilds_avoided"] = static_cast<int64_t>(stats_.lodRebuildsAvoided);
+
+    // Meshes are built on this thread, so its arena is the one generation uses.
+    const ScratchArena &arena = ScratchArena::local();
+    stats["scratch_arena_bytes"] = static_cast<int64_t>(arena.capacity());
+    stats["scratch_arena_peak_bytes"] = static_cast<int64_t>(arena.peakBytes());
+    stats["scratch_arena_overflows"] = static_cast<int64_t>(arena.overflowCount());
+    stats["triangle_reduction"] = stats_.trianglesUniform > 0
+        ? 1.0 - static_cast<f64>(stats_.trianglesEmitted) / static_cast<f64>(stats_.trianglesUniform)
+        : 0.0;
+    return stats;
+}
+
+void TerrainGenerator::reset_generation_stats() noexcept {
+    stats_ = GenerationStats{};
+    ScratchArena::local().resetStats();
+}
+
+bool TerrainGenerator::save_trace(const String &path) const
+{
+#ifdef TERRAIN_TRACE
+    const String file = ProjectSettings::get_singleton()->globalize_path(path);
+    if (!traceWrite(file.utf8().get_data())) {
+        UtilityFunctions::push_warning("TerrainGenerator: could not write trace '", file, "'.");
+        return false;
+    }
+    return true;
+#else
+    UtilityFunctions::push_warning("TerrainGenerator: save_trace needs a build with trace=yes.");
+    return false;
+#endif
+}
+
 i32 TerrainGenerator::get_noise_seed() const {
     return noiseSettings_.seed;
 }
@@ -424,179 +922,682 @@ void TerrainGenerator::set_domain_warp_amplitude(f64 v) {
     noiseSettings_.domain_warp_amp = v;
 }
 
+bool TerrainGenerator::get_erosion_enabled() const {
+    return erosionSettings_.enabled;
+}
+
+void TerrainGenerator::set_erosion_enabled(bool v) {
+    erosionSettings_.enabled = v;
+}
+
+i32 TerrainGenerator::get_erosion_region_chunks() const {
+    return erosionSettings_.region_chunks;
+}
+
+void TerrainGenerator::set_erosion_region_chunks(i32 v) {
+    erosionSettings_.region_chunks = std::max(1, v);
+}
+
+i32 TerrainGenerator::get_erosion_overlap() const {
+    return erosionSettings_.overlap;
+}
+
+void TerrainGenerator::set_erosion_overlap(i32 v) {
+    erosionSettings_.overlap = std::max(0, v);
+}
+
+f64 TerrainGenerator::get_erosion_droplet_density() const {
+    return erosionSettings_.droplet_density;
+}
+
+void TerrainGenerator::set_erosion_droplet_density(f64 v) {
+    erosionSettings_.droplet_density = static_cast<f32>(std::max(0.0, v));
+}
+
+i32 TerrainGenerator::get_erosion_max_droplets() const {
+    return erosionSettings_.max_droplets;
+}
+
+void TerrainGenerator::set_erosion_max_droplets(i32 v) {
+    erosionSettings_.max_droplets = std::max(0, v);
+}
+
+i32 TerrainGenerator::get_erosion_thermal_iterations() const {
+    return erosionSettings_.thermal_iterations;
+}
+
+void TerrainGenerator::set_erosion_thermal_iterations(i32 v) {
+    erosionSettings_.thermal_iterations = std::max(0, v);
+}
+
+f64 TerrainGenerator::get_erosion_strength() const {
+    return erosionSettings_.strength;
+}
+
+void TerrainGenerator::set_erosion_strength(f64 v) {
+    erosionSettings_.strength = static_cast<f32>(std::clamp(v, 0.0, 1.0));
+}
+
+bool TerrainGenerator::get_splat_weights_enabled() const {
+    return splatSettings_.enabled;
+}
+
+void TerrainGenerator::set_splat_weights_enabled(bool v) {
+    splatSettings_.enabled = v;
+}
+
+f64 TerrainGenerator::get_splat_sand_height() const {
+    return splatSettings_.sand_height;
+}
+
+void TerrainGenerator::set_splat_sand_height(f64 v) {
+    splatSettings_.sand_height = static_cast<f32>(v);
+}
+
+f64 TerrainGenerator::get_splat_snow_height() const {
+    return splatSettings_.snow_height;
+}
+
+void TerrainGenerator::set_splat_snow_height(f64 v) {
+    splatSettings_.snow_height = static_cast<f32>(v);
+}
+
+f64 TerrainGenerator::get_splat_rock_slope() const {
+    return splatSettings_.rock_slope;
+}
+
+void TerrainGenerator::set_splat_rock_slope(f64 v) {
+    splatSettings_.rock_slope = static_cast<f32>(v);
+}
+
+f64 TerrainGenerator::get_splat_blend() const {
+    return splatSettings_.blend;
+}
+
+void TerrainGenerator::set_splat_blend(f64 v) {
+    splatSettings_.blend = static_cast<f32>(std::max(0.0, v));
+}
+
+f64 TerrainGenerator::get_splat_biome_frequency() const {
+    return splatSettings_.biome_frequency;
+}
+
+void TerrainGenerator::set_splat_biome_frequency(f64 v) {
+    splatSettings_.biome_frequency = static_cast<f32>(std::max(0.0, v));
+}
+
+bool TerrainGenerator::get_scatter_enabled() const {
+    return scatterSettings_.enabled;
+}
+
+void TerrainGenerator::set_scatter_enabled(bool v) {
+    scatterSettings_.enabled = v;
+}
+
+void TerrainGenerator::set_scatter_mesh(const Ref<Mesh> &mesh) {
+    scatterMesh_ = mesh;
+}
+
+Ref<Mesh> TerrainGenerator::get_scatter_mesh() const {
+    return scatterMesh_;
+}
+
+f64 TerrainGenerator::get_scatter_density() const {
+    return scatterSettings_.density;
+}
+
+void TerrainGenerator::set_scatter_density(f64 v) {
+    scatterSettings_.density = static_cast<f32>(std::max(0.0, v));
+}
+
+i32 TerrainGenerator::get_scatter_max_lod() const {
+    return scatterSettings_.max_lod;
+}
+
+void TerrainGenerator::set_scatter_max_lod(i32 v) {
+    scatterSettings_.max_lod = std::clamp(v, 0, 3);
+}
+
+f64 TerrainGenerator::get_scatter_lod_falloff() const {
+    return scatterSettings_.lod_falloff;
+}
+
+void TerrainGenerator::set_scatter_lod_falloff(f64 v) {
+    scatterSettings_.lod_falloff = static_cast<f32>(std::clamp(v, 0.0, 1.0));
+}
+
+f64 TerrainGenerator::get_scatter_max_slope() const {
+    return scatterSettings_.max_slope;
+}
+
+void TerrainGenerator::set_scatter_max_slope(f64 v) {
+    scatterSettings_.max_slope = static_cast<f32>(std::clamp(v, 0.0, 1.0));
+}
+
+f64 TerrainGenerator::get_scatter_min_scale() const {
+    return scatterSettings_.min_scale;
+}
+
+void TerrainGenerator::set_scatter_min_scale(f64 v) {
+    scatterSettings_.min_scale = static_cast<f32>(v);
+}
+
+f64 TerrainGenerator::get_scatter_max_scale() const {
+    return scatterSettings_.max_scale;
+}
+
+void TerrainGenerator::set_scatter_max_scale(f64 v) {
+    scatterSettings_.max_scale = static_cast<f32>(v);
+}
+
+f64 TerrainGenerator::get_scatter_density_frequency() const {
+    return scatterSettings_.density_frequency;
+}
+
+void TerrainGenerator::set_scatter_density_frequency(f64 v) {
+    scatterSettings_.density_frequency = static_cast<f32>(std::max(0.0, v));
+}
+
 
 
 
 void TerrainGenerator::_ready() 
 {
-    noiseGenerator_->applySettings(noiseSettings_);
+    TRACE_THREAD_NAME("main");
+    auto noise = std::make_shared<NoiseGenerator>();
+    noise->applySettings(noiseSettings_);
+    noiseGenerator_ = std::move(noise);
+
+    // Splat and scatter noise only feed meshes, a heightfield-only server never samples them.
+    if (!heightfieldOnly_ && splatSettings_.enabled && splatSettings_.biome_frequency > 0.0f) {
+        NoiseSettings biome;
+        biome.seed = noiseSettings_.seed + 1;
+        biome.frequency = splatSettings_.biome_frequency;
+        biome.octaves = 3;
+        biomeNoise_ = std::make_unique<NoiseGenerator>();
+        biomeNoise_->applySettings(biome);
+    } else {
+        biomeNoise_.reset();
+    }
+
+    // Mesh scratch for the largest grid this node builds, allocated once up front.
+    ScratchArena::local().reserve(chunkMeshScratchBytes(chunkSize_));
+
+    // Keep every heightfield of the unload window cached, so LOD changes and revisits skip the noise.
+    const size_t window = static_cast<size_t>(2 * unloadRadius_ + 1);
+    heightfieldCache_.clear();
+    heightfieldCache_.setCapacity(window * window);
+
+    if (!heightfieldOnly_ && scatterSettings_.enabled && scatterSettings_.density_frequency > 0.0f) {
+        NoiseSettings density;
+        density.seed = noiseSettings_.seed + 2;
+        density.frequency = scatterSettings_.density_frequency;
+        density.octaves = 2;
+        auto densityNoise = std::make_shared<NoiseGenerator>();
+        densityNoise->applySettings(density);
+        scatterDensityNoise_ = std::move(densityNoise);
+    } else {
+        scatterDensityNoise_.reset();
+    }
+    scatterScheduler_.clear();
 
-    resolvePlayerNode();
-    if (!player_) 
+    erosionRegions_.configure(erosionSettings_, chunkSize_, tileWidth_, tileHeight_, noiseSettings_.seed);
+    openBakedArchive();
+    if ((erosionRegions_.enabled() || (scatterSettings_.enabled && !heightfieldOnly_)) && !workerPool_) {
+        workerPool_ = std::make_unique<WorkerPool>();
+    }
+
+    resolveViewerNodes();
+    collectViewers();
+    if (liveViewers_.empty()) 
     {
-        UtilityFunctions::push_warning("TerrainGenerator: player_node is not set or not a Node3D.");
+        UtilityFunctions::push_warning("TerrainGenerator: neither player_node nor viewer_nodes point to a Node3D.");
         return;
     }
     
-    // Set initial center and enqueue chunks
-    currentChunkCenter_ = chunkFromWorld(player_->get_global_position());
-    has_center_ = true;
-    onCenterChunkChanged(currentChunkCenter_);
+    // Set initial centers and enqueue chunks
+    viewerCenters_.clear();
+    for (Node3D *viewer : liveViewers_) {
+        viewerCenters_.push_back(chunkFromWorld(viewer->get_global_position()));
+    }
+    onViewerCentersChanged();
 }
 
 void TerrainGenerator::_process(double delta)
 {
-    if (!player_) return;
+    TRACE_ZONE("TerrainGenerator::_process");
 
-    const ChunkCoord center = chunkFromWorld(player_->get_global_position());
+    collectViewers();
+    if (liveViewers_.empty()) return;
 
-    if (!has_center_ || !(center == currentChunkCenter_)) 
+    updateFloatingOrigin();
+
+    scratchCenters_.clear();
+    for (Node3D *viewer : liveViewers_) {
+        scratchCenters_.push_back(chunkFromWorld(viewer->get_global_position()));
+    }
+
+    if (scratchCenters_ != viewerCenters_) 
     {
-        has_center_ = true;
-        currentChunkCenter_ = center;
-        onCenterChunkChanged(currentChunkCenter_);
+        viewerCenters_.swap(scratchCenters_);
+        onViewerCentersChanged();
     }
 
+    applyCompletedErosion();
+    applyCompletedScatter();
+
+    // 1) Heightfields first: they are cheap next to meshing and carry the bounds occlusion needs.
+    const ChunkMeshSettings mesh_settings = makeMeshSettings();
     int budget = chunksPerFrame_;
     while (budget-- > 0 && !chunkBuildQueue_.empty()) {
         const BuildRequest req = chunkBuildQueue_.front();
         chunkBuildQueue_.pop_front();
 
+        // Stale: every viewer moved away, or a closer viewer wants another LOD
+        const std::optional<TerrainLevelOfDetail> desired = streamer_.desiredLod(req.coord, viewerCenters_, residentLod(req.coord));
+        if (!desired || *desired != req.lod)
+            continue;
+
         auto it = chunks_.find(req.coord);
-        if (it != chunks_.end() && it->second.lod == req.lod)
+        if (it != chunks_.end() && isChunkUpToDate(req.coord, it->second, req.lod))
             continue;
 
-        ChunkData cd{ req.coord.x, req.coord.z, req.lod };
-        MeshInstance3D* mi = generateChunkMesh(cd);
-        add_child(mi, false);
+        TRACE_ZONE("chunk heightfield");
+        const std::shared_ptr<const Heightfield> heightfield = acquireHeightfield(req.coord, req.lod);
 
         if (it == chunks_.end()) {
-            chunks_.emplace(req.coord, ChunkEntry{mi, req.lod});
-        } else {
-            it->second.node->queue_free();
-            it->second.node = mi;
-            it->second.lod = req.lod;
+            it = chunks_.emplace(req.coord, ChunkEntry{}).first;
+        }
+
+        ChunkEntry &entry = it->second;
+        entry.heightfield = heightfield;
+        entry.lod = req.lod;
+        entry.eroded = heightfield->eroded;
+        entry.refCount = streamer_.countReferences(req.coord, viewerCenters_);
+        chunkHeightRange(*heightfield, mesh_settings, entry.minHeight, entry.maxHeight);
+        occlusionDirty_ = true;
+
+        // Servers stop at the heightfield: no mesh, normals, UVs or nodes.
+        if (heightfieldOnly_) {
+            releaseChunkNode(entry);
+            continue;
+        }
+
+        if (!entry.meshPending) {
+            entry.meshPending = true;
+            pendingMeshes_.push_back(req.coord);
+        }
+    }
+
+    if (heightfieldOnly_) return;
+
+    // 2) Hide chunks behind terrain
+    updateHorizonOcclusion();
+
+    // 3) Meshes for pending chunks, nearest first: the ones somebody can see, then occluded ones with
+    // whatever budget is left, so they are ready once they come into view.
+    budget = chunksPerFrame_;
+    for (const bool occluded : { false, true }) {
+        size_t kept = 0;
+        for (size_t i = 0; i < pendingMeshes_.size(); i++) {
+            const ChunkCoord coord = pendingMeshes_[i];
+            auto it = chunks_.find(coord);
+            if (it == chunks_.end() || !it->second.meshPending) continue; // unloaded or built meanwhile
+
+            if (budget <= 0 || it->second.occluded != occluded) {
+                pendingMeshes_[kept++] = coord;
+                continue;
+            }
+
+            budget--;
+            buildChunkNode(coord, it->second);
         }
+        pendingMeshes_.resize(kept);
+    }
+}
+
+void TerrainGenerator::buildChunkNode(const ChunkCoord& coord, ChunkEntry& entry)
+{
+    TRACE_ZONE("buildChunkNode");
+
+    ChunkData cd{ coord.x, coord.z, entry.lod };
+    MeshInstance3D* mi = generateChunkMesh(cd, *entry.heightfield);
+    {
+        TRACE_ZONE("add_child");
+        add_child(mi, false);
     }
 
+    const bool wants_scatter = isScatterActive() && static_cast<i32>(entry.lod) <= scatterSettings_.max_lod;
+
+    if (entry.node) {
+        // Carry the old instances over until the new set arrives, so LOD swaps do not blink.
+        MultiMeshInstance3D *scatter = entry.scatter;
+        entry.scatter = nullptr;
+        if (scatter) entry.node->remove_child(scatter);
+        {
+            TRACE_ZONE("queue_free");
+            entry.node->queue_free();
+        }
+
+        if (scatter && wants_scatter) {
+            mi->add_child(scatter, false);
+            entry.scatter = scatter;
+        } else if (scatter) {
+            recycleScatterNode(scatter);
+        }
+    }
+
+    mi->set_visible(!entry.occluded);
+    entry.node = mi;
+    entry.meshPending = false;
+    entry.buildId = ++nextBuildId_;
+
+    if (wants_scatter) {
+        scatterScheduler_.schedule(entry.heightfield, entry.buildId, makeMeshSettings(), scatterSettings_,
+                                   scatterDensityNoise_, noiseSettings_.seed, *workerPool_);
+    }
 }
 
-MeshInstance3D *TerrainGenerator::generateChunkMesh(const ChunkData& chunkData) const noexcept {
-    MeshInstance3D *meshInstance = memnew(MeshInstance3D);
+void TerrainGenerator::updateHorizonOcclusion()
+{
+    TRACE_ZONE("updateHorizonOcclusion");
+
+    if (!horizonOcclusion_) {
+        // Switched off: bring back whatever the last pass hid.
+        if (stats_.chunksOccluded == 0) return;
+        for (auto &[coord, entry] : chunks_) {
+            entry.occluded = false;
+            if (entry.node && !entry.node->is_visible()) entry.node->set_visible(true);
+        }
+        stats_.chunksOccluded = 0;
+        return;
+    }
 
-    Ref<ArrayMesh> mesh;
-    mesh.instantiate();
+    const f64 s = (f64)chunkSize_ * tileWidth_;
 
-    int lod_i = static_cast<int>(chunkData.lod);
-    lod_i = std::clamp(lod_i, 0, 6);
+    // The pass only depends on the eyes and the loaded chunk bounds; skip it until the bounds change
+    // or an eye moves further than a fraction of a chunk from where the last pass saw it.
+    occlusionEyeScratch_.clear();
+    for (Node3D *viewer : liveViewers_) {
+        occlusionEyeScratch_.push_back(viewer->get_global_position());
+    }
 
-    // Ensure step <= chunkSize_
-    while ((1 << lod_i) > static_cast<int>(chunkSize_) && lod_i > 0) {
-        lod_i--;
+    bool eyes_moved = occlusionEyeScratch_.size() != occlusionEyes_.size();
+    const real_t tolerance = static_cast<real_t>(occlusionEyeTolerance * s);
+    for (size_t i = 0; i < occlusionEyeScratch_.size() && !eyes_moved; i++) {
+        eyes_moved = occlusionEyeScratch_[i].distance_squared_to(occlusionEyes_[i]) > tolerance * tolerance;
     }
 
-    const int step = 1 << lod_i;
-    const int squares_per_side = static_cast<int>(chunkSize_) / step;
-    const int verts_per_side = squares_per_side + 1;
+    if (!occlusionDirty_ && !eyes_moved) return;
+    occlusionEyes_.swap(occlusionEyeScratch_);
+    occlusionDirty_ = false;
 
-    const float tile = static_cast<float>(tileWidth_);
-    const float quad_size = tile * static_cast<float>(step);
+    occlusionBoxes_.clear();
+    occlusionEntries_.clear();
+    for (auto &[coord, entry] : chunks_) {
+        if (!entry.heightfield) continue;
 
-    const double chunk_world_x0 = static_cast<double>(chunkData.x) * static_cast<double>(chunkSize_) * tileWidth_;
-    const double chunk_world_z0 = static_cast<double>(chunkData.z) * static_cast<double>(chunkSize_) * tileWidth_;
+        const f32 x0 = static_cast<f32>(static_cast<f64>(coord.x - originChunk_.x) * s);
+        const f32 z0 = static_cast<f32>(static_cast<f64>(coord.z - originChunk_.z) * s);
+        occlusionBoxes_.push_back(OcclusionBox{ x0, z0, x0 + static_cast<f32>(s), z0 + static_cast<f32>(s), entry.minHeight, entry.maxHeight });
+        occlusionEntries_.push_back(&entry);
+    }
 
-    const int vertex_count = verts_per_side * verts_per_side;
-    const int index_count = squares_per_side * squares_per_side * 6;
+    // Hidden only when no viewer can see it.
+    occlusionHidden_.assign(occlusionBoxes_.size(), 1);
+    for (const Vector3 &eye : occlusionEyes_) {
+        horizon_.compute(eye.x, eye.y, eye.z, occlusionBoxes_, static_cast<f32>(horizonOcclusionMargin_), occlusionScratch_);
 
-    PackedVector3Array vertices;
-    vertices.resize(vertex_count);
+        for (size_t i = 0; i < occlusionHidden_.size(); i++) {
+            occlusionHidden_[i] &= occlusionScratch_[i];
+        }
+    }
 
-    PackedVector3Array normals;
-    normals.resize(vertex_count);
-    for (int i = 0; i < vertex_count; i++) {
-        normals.set(i, Vector3(0, 0, 0));
+    stats_.chunksOccluded = 0;
+    for (size_t i = 0; i < occlusionEntries_.size(); i++) {
+        ChunkEntry &entry = *occlusionEntries_[i];
+        entry.occluded = occlusionHidden_[i] != 0;
+        if (entry.occluded) stats_.chunksOccluded++;
+
+        if (entry.node && entry.node->is_visible() == entry.occluded) {
+            entry.node->set_visible(!entry.occluded);
+        }
     }
+}
 
-    PackedVector2Array uvs;
-    uvs.resize(vertex_count);
+std::shared_ptr<const Heightfield> TerrainGenerator::acquireHeightfield(const ChunkCoord& coord, TerrainLevelOfDetail lod)
+{
+    if (auto cached = heightfieldCache_.find(coord, lod)) {
+        return cached;
+    }
 
-    PackedInt32Array indices;
-    indices.resize(index_count);
+    // Baked chunks replace generation; openBakedArchive only keeps archives baked with the node's settings.
+    if (bakedArchive_) {
+        if (std::shared_ptr<const Heightfield> baked = bakedArchive_->loadHeightfield(coord, lod)) {
+            heightfieldCache_.insert(baked);
+            return baked;
+        }
+    }
 
-    auto vid = [verts_per_side](int vx, int vz) -> int {
-        return vz * verts_per_side + vx;
-    };
+    std::shared_ptr<const Heightfield> heightfield;
 
-    for (int vz = 0; vz < verts_per_side; vz++) {
-        for (int vx = 0; vx < verts_per_side; vx++) {
-            const int i = vid(vx, vz);
+    if (erosionRegions_.enabled()) {
+        if (erosionRegions_.findForChunk(coord, chunkRegions_)) {
+            heightfield = sampleHeightfieldFromRegions(chunkRegions_, coord, lod, chunkSize_);
+        } else {
+            // Show raw noise now, the chunk is rebuilt once every region it blends from is eroded.
+            erosionRegions_.requestForChunk(coord, noiseGenerator_, *workerPool_);
+        }
+        chunkRegions_.clear();
+    }
 
-            const double world_x = chunk_world_x0 + static_cast<double>(vx) * static_cast<double>(quad_size);
-            const double world_z = chunk_world_z0 + static_cast<double>(vz) * static_cast<double>(quad_size);
+    if (!heightfield) {
+        heightfield = sampleHeightfield(*noiseGenerator_, coord, lod, chunkSize_, tileWidth_);
+    }
 
-            auto noiseValue = noiseGenerator_->getNoiseValue(world_x, world_z);
+    heightfieldCache_.insert(heightfield);
+    return heightfield;
+}
 
-            // Set to water level if below
-            if(noiseValue <= waterLevel_) {
-                noiseValue = waterLevel_;
-            }
+std::optional<TerrainLevelOfDetail> TerrainGenerator::residentLod(const ChunkCoord& coord) const
+{
+    auto it = chunks_.find(coord);
+    if (it == chunks_.end()) return std::nullopt;
+    return it->second.lod;
+}
 
-            const double h = noiseValue * tileHeight_;
-            const float px = static_cast<float>(vx) * quad_size;
-            const float py = static_cast<float>(h);
-            const float pz = static_cast<float>(vz) * quad_size;
+bool TerrainGenerator::isChunkUpToDate(const ChunkCoord& coord, const ChunkEntry& entry, TerrainLevelOfDetail lod) const
+{
+    if (entry.lod != lod) return false;
+    if (entry.eroded || !erosionRegions_.enabled()) return true;
 
-            vertices.set(i, Vector3(px, py, pz));
+    // Raw chunk: only stale once the regions it blends from have finished eroding.
+    return !erosionRegions_.readyForChunk(coord);
+}
 
-            const float u = (verts_per_side > 1) ? (float)vx / (float)(verts_per_side - 1) : 0.0f;
-            const float v = (verts_per_side > 1) ? (float)vz / (float)(verts_per_side - 1) : 0.0f;
-            uvs.set(i, Vector2(u, v));
+void TerrainGenerator::applyCompletedErosion()
+{
+    if (!erosionRegions_.enabled()) return;
+    TRACE_ZONE("applyCompletedErosion");
+
+    completedRegions_.clear();
+    erosionRegions_.takeCompleted(completedRegions_);
+    if (completedRegions_.empty()) return;
+
+    const i32 region_chunks = erosionRegions_.regionChunks();
+
+    for (const ChunkCoord& region : completedRegions_) {
+        // Chunks along the border of a neighbouring region blend this one in as well.
+        heightfieldCache_.eraseIf([&](const Heightfield& hf) {
+            const ChunkCoord r = erosionRegions_.regionForChunk(hf.coord);
+            return !hf.eroded && chebyshevDist(r.x - region.x, r.z - region.z) <= 1;
+        });
+
+        // Swap resident raw chunks for their eroded version once all their regions are in
+        for (i32 dz = -1; dz <= region_chunks; dz++) {
+            for (i32 dx = -1; dx <= region_chunks; dx++) {
+                const ChunkCoord c{ region.x * region_chunks + dx, region.z * region_chunks + dz };
+                auto it = chunks_.find(c);
+                if (it != chunks_.end() && !it->second.eroded && erosionRegions_.readyForChunk(c)) {
+                    chunkBuildQueue_.push_back(BuildRequest{c, it->second.lod});
+                }
+            }
         }
     }
+}
+
+ChunkMeshSettings TerrainGenerator::makeMeshSettings() const noexcept
+{
+    ChunkMeshSettings settings;
+    settings.chunkSize = chunkSize_;
+    settings.tileWidth = tileWidth_;
+    settings.tileHeight = tileHeight_;
+    settings.waterLevel = waterLevel_;
+    settings.splat = splatSettings_;
+    settings.simplify = simplifyMesh_;
+    settings.simplifyError = static_cast<f32>(simplifyError_);
+    settings.morph = lodMorph_;
+    return settings;
+}
+
+bool TerrainGenerator::isScatterActive() const noexcept
+{
+    return !heightfieldOnly_ && scatterSettings_.enabled && scatterMesh_.is_valid() && workerPool_ != nullptr;
+}
+
+void TerrainGenerator::applyCompletedScatter()
+{
+    TRACE_ZONE("applyCompletedScatter");
+
+    completedScatter_.clear();
+    scatterScheduler_.takeCompleted(completedScatter_);
 
-    int idx = 0;
-    for (int z = 0; z < squares_per_side; z++) {
-        for (int x = 0; x < squares_per_side; x++) {
-            const int v00 = vid(x, z);
-            const int v10 = vid(x + 1, z);
-            const int v01 = vid(x, z + 1);
-            const int v11 = vid(x + 1, z + 1);
-
-            indices.set(idx++, v00);
-            indices.set(idx++, v11);
-            indices.set(idx++, v01);
-            indices.set(idx++, v00);
-            indices.set(idx++, v10);
-            indices.set(idx++, v11);
+    for (const ScatterData &data : completedScatter_) {
+        auto it = chunks_.find(data.coord);
+
+        // Chunk unloaded or rebuilt since the job was queued
+        if (it == chunks_.end() || it->second.buildId != data.buildId || !it->second.node) continue;
+
+        ChunkEntry &entry = it->second;
+
+        if (data.instanceCount == 0) {
+            if (entry.scatter) {
+                entry.node->remove_child(entry.scatter);
+                recycleScatterNode(entry.scatter);
+                entry.scatter = nullptr;
+            }
+            continue;
+        }
+
+        if (!entry.scatter) {
+            entry.scatter = acquireScatterNode();
+            entry.node->add_child(entry.scatter, false);
         }
+
+        PackedFloat32Array buffer;
+        buffer.resize(static_cast<int64_t>(data.transforms.size()));
+        std::copy(data.transforms.begin(), data.transforms.end(), buffer.ptrw());
+
+        Ref<MultiMesh> multimesh = entry.scatter->get_multimesh();
+        multimesh->set_instance_count(static_cast<int32_t>(data.instanceCount));
+        multimesh->set_buffer(buffer);
     }
+}
 
-    for (int t = 0; t < index_count; t += 3) {
-        const int ia = indices[t + 0];
-        const int ib = indices[t + 1];
-        const int ic = indices[t + 2];
+MultiMeshInstance3D *TerrainGenerator::acquireScatterNode()
+{
+    MultiMeshInstance3D *scatter = nullptr;
+
+    if (!scatterPool_.empty()) {
+        scatter = scatterPool_.back();
+        scatterPool_.pop_back();
+    } else {
+        scatter = memnew(MultiMeshInstance3D);
+
+        Ref<MultiMesh> multimesh;
+        multimesh.instantiate();
+        multimesh->set_transform_format(MultiMesh::TRANSFORM_3D);
+        scatter->set_multimesh(multimesh);
+    }
 
-        const Vector3 a = vertices[ia];
-        const Vector3 b = vertices[ib];
-        const Vector3 c = vertices[ic];
+    scatter->get_multimesh()->set_mesh(scatterMesh_);
+    return scatter;
+}
 
-        const Vector3 n = (b - a).cross(c - a);
+void TerrainGenerator::recycleScatterNode(MultiMeshInstance3D *scatter)
+{
+    if (scatterPool_.size() >= maxPooledScatterNodes) {
+        memdelete(scatter);
+        return;
+    }
 
-        normals.set(ia, normals[ia] + n);
-        normals.set(ib, normals[ib] + n);
-        normals.set(ic, normals[ic] + n);
+    scatter->get_multimesh()->set_instance_count(0);
+    scatterPool_.push_back(scatter);
+}
+
+void TerrainGenerator::releaseChunkNode(ChunkEntry &entry)
+{
+    if (!entry.node) return;
+
+    if (entry.scatter) {
+        entry.node->remove_child(entry.scatter);
+        recycleScatterNode(entry.scatter);
+        entry.scatter = nullptr;
     }
 
+    TRACE_ZONE("queue_free");
+    entry.node->queue_free();
+    entry.node = nullptr;
+}
+
+MeshInstance3D *TerrainGenerator::generateChunkMesh(const ChunkData& chunkData, const Heightfield& heightfield) noexcept {
+    TRACE_ZONE("generateChunkMesh");
+
+    MeshInstance3D *meshInstance = memnew(MeshInstance3D);
+
+    Ref<ArrayMesh> mesh;
+    mesh.instantiate();
+
+    const ChunkMeshSettings settings = makeMeshSettings();
+
+    ChunkMeshData &data = meshData_;
+    const bool baked = bakedMeshes_ && chunkData.lod == TerrainLevelOfDetail::LEVEL_0
+        && bakedArchive_->loadMesh(ChunkCoord{ chunkData.x, chunkData.z }, data);
+    if (!baked) {
+        buildChunkMesh(heightfield, settings, biomeNoise_.get(), data);
+    } else if (settings.morph) {
+        computeMorphTargets(heightfield, settings, data);
+    }
+
+    stats_.chunksBuilt++;
+    stats_.trianglesEmitted += data.triangleCount();
+    stats_.trianglesUniform += data.uniformTriangleCount;
+
+    const int vertex_count = static_cast<int>(data.vertexCount());
+    const int index_count = static_cast<int>(data.indices.size());
+
+    PackedVector3Array vertices;
+    vertices.resize(vertex_count);
+    Vector3 *vw = vertices.ptrw();
+
+    PackedVector3Array normals;
+    normals.resize(vertex_count);
+    Vector3 *nw = normals.ptrw();
+
+    PackedVector2Array uvs;
+    uvs.resize(vertex_count);
+    Vector2 *uw = uvs.ptrw();
+
     for (int i = 0; i < vertex_count; i++) {
-        Vector3 n = normals[i];
-        if (n.length_squared() > 0.000001f) {
-            n = n.normalized();
-        } else {
-            n = Vector3(0, 1, 0);
-        }
-        normals.set(i, n);
+        vw[i] = Vector3(data.positions[i * 3 + 0], data.positions[i * 3 + 1], data.positions[i * 3 + 2]);
+        nw[i] = Vector3(data.normals[i * 3 + 0], data.normals[i * 3 + 1], data.normals[i * 3 + 2]);
+        uw[i] = Vector2(data.uvs[i * 2 + 0], data.uvs[i * 2 + 1]);
     }
 
+    PackedInt32Array indices;
+    indices.resize(index_count);
+    std::copy(data.indices.begin(), data.indices.end(), indices.ptrw());
+
     Array arrays;
     arrays.resize(Mesh::ARRAY_MAX);
     arrays[Mesh::ARRAY_VERTEX] = vertices;
@@ -604,17 +1605,65 @@ MeshInstance3D *TerrainGenerator::generateChunkMesh(const ChunkData& chunkData)
     arrays[Mesh::ARRAY_TEX_UV] = uvs;
     arrays[Mesh::ARRAY_INDEX]  = indices;
 
-    mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays);
+    int64_t format_flags = 0;
+    if (!data.weights.empty()) {
+        PackedByteArray weights;
+        weights.resize(static_cast<int64_t>(data.weights.size()));
+        std::copy(data.weights.begin(), data.weights.end(), weights.ptrw());
+
+        arrays[Mesh::ARRAY_CUSTOM0] = weights;
+        format_flags |= static_cast<int64_t>(Mesh::ARRAY_CUSTOM_RGBA8_UNORM) << Mesh::ARRAY_FORMAT_CUSTOM0_SHIFT;
+    }
+
+    if (!data.morphTargets.empty()) {
+        PackedFloat32Array morph_targets;
+        morph_targets.resize(static_cast<int64_t>(data.morphTargets.size()));
+        std::copy(data.morphTargets.begin(), data.morphTargets.end(), morph_targets.ptrw());
+
+        arrays[Mesh::ARRAY_CUSTOM1] = morph_targets;
+        format_flags |= static_cast<int64_t>(Mesh::ARRAY_CUSTOM_RGBA_FLOAT) << Mesh::ARRAY_FORMAT_CUSTOM1_SHIFT;
+    }
+
+    {
+        TRACE_ZONE("add_surface_from_arrays");
+        mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays, TypedArray<Array>(), Dictionary(), format_flags);
+    }
+
+    // Culling bounds straight from the heightfield range instead of the vertex scan.
+    f32 min_height = 0.0f;
+    f32 max_height = 0.0f;
+    chunkHeightRange(heightfield, settings, min_height, max_height);
+    const real_t extent = static_cast<real_t>(static_cast<f64>(chunkSize_) * tileWidth_);
+    mesh->set_custom_aabb(AABB(Vector3(0.0f, min_height, 0.0f), Vector3(extent, max_height - min_height, extent)));
+
     meshInstance->set_mesh(mesh);
 
     if (terrain_material_.is_valid()) {
         meshInstance->set_material_override(terrain_material_);
     }
 
+    // Band, in camera distance, over which the vertices slide onto the coarser LOD. It ends at the
+    // farthest distance the streamer keeps a chunk at this LOD, hysteresis included, so chunks are
+    // fully morphed by the time they switch. LOD3 has nothing coarser and gets a band out of reach.
+    if (settings.morph) {
+        Vector2 morph_range(1e9f, 2e9f);
+        if (chunkData.lod != TerrainLevelOfDetail::LEVEL_3) {
+            const f64 s = static_cast<f64>(chunkSize_) * tileWidth_;
+            const f64 morph_end = static_cast<f64>(streamer_.lodKeptUntil(chunkData.lod)) * s;
+            const f64 morph_start = std::max(0.0, morph_end - lodMorphRange_ * s);
+            morph_range = Vector2(static_cast<real_t>(morph_start), static_cast<real_t>(std::max(morph_end, morph_start + 0.001)));
+        }
+        meshInstance->set_instance_shader_parameter("morph_range", morph_range);
+    }
+
+    // Relative to the floating origin, so float positions stay small however far out the chunk is.
+    const double chunk_local_x0 = static_cast<double>(chunkData.x - originChunk_.x) * static_cast<double>(chunkSize_) * tileWidth_;
+    const double chunk_local_z0 = static_cast<double>(chunkData.z - originChunk_.z) * static_cast<double>(chunkSize_) * tileWidth_;
+
     meshInstance->set_position(Vector3(
-        static_cast<float>(chunk_world_x0),
+        static_cast<float>(chunk_local_x0),
         0.0f,
-        static_cast<float>(chunk_world_z0)
+        static_cast<float>(chunk_local_z0)
     ));
 
     return meshInstance;
@@ -624,73 +1673,196 @@ ChunkCoord TerrainGenerator::chunkFromWorld(const Vector3 &worldPosition) const
 {
     const f64 s = (f64)chunkSize_ * tileWidth_;
     return ChunkCoord{
-        (i32)std::floor(worldPosition.x / s),
-        (i32)std::floor(worldPosition.z / s)
+        (i64)std::floor(worldPosition.x / s) + originChunk_.x,
+        (i64)std::floor(worldPosition.z / s) + originChunk_.z
     };
 }
 
-void TerrainGenerator::onCenterChunkChanged(const ChunkCoord &center) {
-    // 1) enqueue chunks in view radius with appropriate LOD
-    for (int dz = -viewRadius_; dz <= viewRadius_; dz++) {
-        for (int dx = -viewRadius_; dx <= viewRadius_; dx++) {
-            ChunkCoord c{ center.x + dx, center.z + dz };
+void TerrainGenerator::updateFloatingOrigin()
+{
+    if (!floatingOrigin_ || liveViewers_.empty()) return;
 
-            const int dist = chebyshevDist(dx, dz);
-            TerrainLevelOfDetail desired = lodForDistance(dist);
+    const f64 s = (f64)chunkSize_ * tileWidth_;
+    if (s <= 0.0) return;
 
-            auto it = chunks_.find(c);
+    // The primary viewer (player_node, else the first viewer) drives the origin.
+    Node3D *primary = liveViewers_.front();
+    const Vector3 local = primary->get_global_position();
+    if (std::abs(local.x) < floatingOriginThreshold_ && std::abs(local.z) < floatingOriginThreshold_) return;
 
-            // Not loaded -> schedule build
-            if (it == chunks_.end()) {
-                chunkBuildQueue_.push_back(BuildRequest{c, desired});
-                continue;
-            }
+    // Re-centre on the primary viewer's chunk; whole chunks keep every chunk on the same local grid.
+    const i64 shift_x = (i64)std::floor(local.x / s);
+    const i64 shift_z = (i64)std::floor(local.z / s);
+    originChunk_.x += shift_x;
+    originChunk_.z += shift_z;
 
-            // Loaded but wrong LOD -> schedule rebuild (replace mesh)
-            if (it->second.lod != desired) {
-                chunkBuildQueue_.push_back(BuildRequest{c, desired});
-            }
-        }
+    const Vector3 offset(
+        static_cast<real_t>(-static_cast<f64>(shift_x) * s),
+        0.0f,
+        static_cast<real_t>(-static_cast<f64>(shift_z) * s)
+    );
+
+    // Only transforms move, meshes are untouched.
+    for (auto &[coord, entry] : chunks_) {
+        if (entry.node) entry.node->set_position(entry.node->get_position() + offset);
+    }
+
+    // Viewers live in the same world; skip those that move with a viewer ancestor.
+    for (Node3D *viewer : liveViewers_) {
+        const bool nested = std::any_of(liveViewers_.begin(), liveViewers_.end(), [viewer](Node3D *other) {
+            return other != viewer && other->is_ancestor_of(viewer);
+        });
+        if (!nested) viewer->set_global_position(viewer->get_global_position() + offset);
     }
 
-    // 2) unload chunks outside unload radius (unchanged idea)
-    const int unload2 = unloadRadius_ * unloadRadius_;
+    emit_signal("origin_shifted", offset);
+}
+
+StreamingSettings TerrainGenerator::makeStreamingSettings() const noexcept
+{
+    StreamingSettings settings;
+    settings.viewRadius = viewRadius_;
+    settings.unloadRadius = unloadRadius_;
+    settings.lodLevel0Distance = lodLevel0Distance_;
+    settings.lodLevel1Distance = lodLevel1Distance_;
+    settings.lodLevel2Distance = lodLevel2Distance_;
+    settings.lodHysteresis = lodHysteresis_;
+    return settings;
+}
+
+void TerrainGenerator::onViewerCentersChanged() {
+    TRACE_ZONE("onViewerCentersChanged");
+
+    streamer_.configure(makeStreamingSettings());
+    occlusionDirty_ = true;
+
+    // 1) replan the union of all view windows, each chunk at the LOD of its nearest viewer
+    plannedBuilds_.clear();
+    {
+        TRACE_ZONE("planBuilds");
+        stats_.lodRebuildsAvoided += streamer_.planBuilds(viewerCenters_, [this](const ChunkCoord &c) {
+            return residentLod(c);
+        }, [this](const ChunkCoord &c, TerrainLevelOfDetail lod) {
+            auto it = chunks_.find(c);
+            return it == chunks_.end() || !isChunkUpToDate(c, it->second, lod);
+        }, plannedBuilds_);
+    }
+
+    // The plan covers everything still missing, older requests would only be skipped later.
+    chunkBuildQueue_.assign(plannedBuilds_.begin(), plannedBuilds_.end());
+
+    // 2) unload chunks no viewer references anymore
     for (auto it = chunks_.begin(); it != chunks_.end(); ) {
-        const int ddx = it->first.x - center.x;
-        const int ddz = it->first.z - center.z;
-        const int dist2 = ddx * ddx + ddz * ddz;
+        it->second.refCount = streamer_.countReferences(it->first, viewerCenters_);
 
-        if (dist2 > unload2) {
-            if (it->second.node) it->second.node->queue_free();
+        if (it->second.refCount == 0) {
+            releaseChunkNode(it->second);
             it = chunks_.erase(it);
         } else {
             ++it;
         }
     }
+
+    // 3) drop eroded regions nobody can reach anymore
+    if (erosionRegions_.enabled()) {
+        regionCenters_.clear();
+        for (const ChunkCoord &center : viewerCenters_) {
+            regionCenters_.push_back(erosionRegions_.regionForChunk(center));
+        }
+
+        // One more ring for the neighbours border chunks blend from
+        const i32 region_radius = unloadRadius_ / erosionRegions_.regionChunks() + 2;
+        erosionRegions_.evictOutside(regionCenters_, region_radius);
+    }
+}
+
+void TerrainGenerator::resolveViewerNodes()
+{
+    viewerIds_.clear();
+
+    auto add = [this](const NodePath &path) {
+        if (path.is_empty()) return;
+
+        Node3D *viewer = Object::cast_to<Node3D>(get_node_or_null(path));
+        if (!viewer) return;
+
+        const u64 id = viewer->get_instance_id();
+        if (std::find(viewerIds_.begin(), viewerIds_.end(), id) == viewerIds_.end()) {
+            viewerIds_.push_back(id);
+        }
+    };
+
+    add(player_path_);
+    for (int64_t i = 0; i < viewer_paths_.size(); i++) {
+        add(viewer_paths_[i]);
+    }
 }
 
-TerrainLevelOfDetail TerrainGenerator::lodForDistance(int dist_chunks) const noexcept
+void TerrainGenerator::collectViewers()
 {
-    if (dist_chunks <= lodLevel0Distance_) return TerrainLevelOfDetail::LEVEL_0;
-    if (dist_chunks <= lodLevel1Distance_) return TerrainLevelOfDetail::LEVEL_1;
-    if (dist_chunks <= lodLevel2Distance_) return TerrainLevelOfDetail::LEVEL_2;
-    return TerrainLevelOfDetail::LEVEL_3;
+    liveViewers_.clear();
+
+    for (const u64 id : viewerIds_) {
+        if (Node3D *viewer = Object::cast_to<Node3D>(ObjectDB::get_instance(id))) {
+            liveViewers_.push_back(viewer);
+        }
+    }
 }
 
-void TerrainGenerator::resolvePlayerNode()
+void TerrainGenerator::openBakedArchive()
 {
-    player_ = nullptr;
+    bakedArchive_.reset();
+    bakedMeshes_ = false;
+    if (baked_archive_path_.is_empty()) return;
 
-    if (player_path_.is_empty()) {
+    Ref<FileAccess> file = FileAccess::open(baked_archive_path_, FileAccess::READ);
+    if (file.is_null()) {
+        UtilityFunctions::push_warning("TerrainGenerator: cannot open baked archive ", baked_archive_path_);
         return;
     }
 
-    Node *n = get_node_or_null(player_path_);
-    if (!n) {
+    // Tiles are read on demand through the engine, so archives inside exported packs work too.
+    auto archive = std::make_unique<TerrainArchive>();
+    const bool opened = archive->open([file](u64 offset, u8 *dst, size_t size) {
+        file->seek(offset);
+        const PackedByteArray bytes = file->get_buffer(static_cast<int64_t>(size));
+        if (bytes.size() != static_cast<int64_t>(size)) return false;
+        std::copy(bytes.ptr(), bytes.ptr() + size, dst);
+        return true;
+    });
+
+    if (!opened) {
+        UtilityFunctions::push_warning("TerrainGenerator: ", baked_archive_path_, " is not a terrain archive.");
         return;
     }
 
-    player_ = Object::cast_to<Node3D>(n);
+    // The archive stores its outer border samples exactly, so with the same layout, settings and
+    // seed, generated neighbours compute identical shared heights; anything else would leave seams.
+    // Inside the rectangle heights are quantized in steps of 1/43690 of the normalized height.
+    // Erosion also scales with tile_height, so an eroded bake has to match that too.
+    const TerrainArchiveHeader &header = archive->header();
+    if (header.chunkSize != chunkSize_ || header.tileWidth != tileWidth_ || header.seed != noiseSettings_.seed) {
+        UtilityFunctions::push_warning("TerrainGenerator: ", baked_archive_path_, " was baked with another chunk_size, tile_width or noise_seed; ignoring it.");
+        return;
+    }
+    if (header.generationHash != terrainGenerationHash(noiseSettings_, erosionSettings_)
+        || (header.eroded && header.tileHeight != tileHeight_)) {
+        UtilityFunctions::push_warning("TerrainGenerator: ", baked_archive_path_, " was baked with other noise or erosion settings; ignoring it.");
+        return;
+    }
+
+    // Baked meshes carry no splat weights and were triangulated with the bake's settings.
+    const bool same_simplification = simplifyMesh_
+        ? header.simplifyError == static_cast<f32>(simplifyError_)
+        : header.simplifyError == 0.0f;
+
+    bakedMeshes_ = header.hasMeshes
+        && header.tileHeight == tileHeight_
+        && header.waterLevel == waterLevel_
+        && !splatSettings_.enabled
+        && same_simplification;
+
+    bakedArchive_ = std::move(archive);
 }
 
-}
\ No newline at end of file
+}
@@ -2,66 +2,65 @@
 
 #include "utils.h"
 #include "noise_generator.h"
+#include "chunk_types.h"
+#include "heightfield.h"
+#include "chunk_mesh_builder.h"
+#include "scatter.h"
+#include "chunk_streamer.h"
+#include "terrain_erosion.h"
+#include "terrain_archive.h"
+#include "horizon_occlusion.h"
+#include "worker_pool.h"
 
 // Godot
 #include "godot_cpp/classes/node3d.hpp"
 #include "godot_cpp/classes/mesh_instance3d.hpp"
 #include "godot_cpp/classes/material.hpp"
+#include "godot_cpp/classes/mesh.hpp"
+#include "godot_cpp/classes/multi_mesh_instance3d.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/typed_array.hpp"
 
 // std
 #include <memory>
 #include <unordered_map>
 #include <deque>
+#include <vector>
+#include <optional>
 
 namespace godot 
 {
 
-enum class TerrainLevelOfDetail : u8
-{
-	LEVEL_0 = 0,
-	LEVEL_1 = 1,
-	LEVEL_2 = 2,
-	LEVEL_3 = 3
-};
-
 struct ChunkEntry {
     MeshInstance3D *node = nullptr;
     TerrainLevelOfDetail lod = TerrainLevelOfDetail::LEVEL_0;
+    bool eroded = false;
+    MultiMeshInstance3D *scatter = nullptr; // child of node, recycled with the chunk
+    u32 buildId = 0;
+    u32 refCount = 0; // viewers whose unload radius covers the chunk
+    std::shared_ptr<const Heightfield> heightfield; // samples the chunk was built from, for height queries
+    f32 minHeight = 0.0f; // surface bounds in world units, chunk local
+    f32 maxHeight = 0.0f;
+    bool meshPending = false; // heightfield is current, the mesh still has to be built
+    bool occluded = false;    // behind terrain for every viewer at the last horizon pass
 };
 
-struct ChunkCoord {
-    i32 x;
-    i32 z;
-
-    bool operator==(const ChunkCoord& o) const noexcept {
-        return x == o.x && z == o.z;
-    }
-};
-
-struct BuildRequest {
-    ChunkCoord coord;
-    TerrainLevelOfDetail lod;
+struct GenerationStats {
+    u64 chunksBuilt = 0;
+    u64 trianglesEmitted = 0;
+    u64 trianglesUniform = 0; // what the plain grids would have cost
+    u64 chunksOccluded = 0;   // hidden at the last horizon pass
+    u64 lodRebuildsAvoided = 0; // threshold crossings absorbed by LOD hysteresis
 };
 
 
 struct ChunkData
 {
-	i32 x;
-	i32 z;
+	i64 x;
+	i64 z;
 	TerrainLevelOfDetail lod = TerrainLevelOfDetail::LEVEL_0;
 };
 
-struct ChunkCoordHash {
-    size_t operator()(const ChunkCoord& c) const noexcept {
-        size_t h1 = std::hash<i32>{}(c.x);
-        size_t h2 = std::hash<i32>{}(c.z);
-        size_t h = h1;
-        h ^= h2 + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
-        return h;
-    }
-};
-
-
 class TerrainGenerator : public Node3D
 {
 	GDCLASS(TerrainGenerator, Node3D)
@@ -71,7 +70,7 @@ protected:
 
 public:
 	TerrainGenerator();
-	~TerrainGenerator() = default;
+	~TerrainGenerator();
 
 public:
 	// Implements Node functions
@@ -92,9 +91,15 @@ public:
     void set_player_node(const NodePath &path);
     NodePath get_player_node() const;
 
+    void set_viewer_nodes(const TypedArray<NodePath> &paths);
+    TypedArray<NodePath> get_viewer_nodes() const;
+
 	void set_terrain_material(const Ref<Material> &material);
 	Ref<Material> get_terrain_material() const;
 
+	void set_baked_archive(const String &path);
+	String get_baked_archive() const;
+
 	void set_view_radius(i32 radius) noexcept;
 	i32 get_view_radius() const noexcept;
 
@@ -104,6 +109,12 @@ public:
 	void set_chunks_per_frame(i32 count) noexcept;
 	i32 get_chunks_per_frame() const noexcept;
 
+	void set_heightfield_only(bool enabled) noexcept;
+	bool get_heightfield_only() const noexcept;
+
+	// Terrain height under a position in the generator's space, in world units.
+	f64 get_height_at(const Vector3 &position) const;
+
 	void set_lod_level_0_distance(i32 distance) noexcept;
 	i32 get_lod_level_0_distance() const noexcept;
 
@@ -113,9 +124,45 @@ public:
 	void set_lod_level_2_distance(i32 distance) noexcept;
 	i32 get_lod_level_2_distance() const noexcept;
 
+	void set_lod_hysteresis(i32 chunks) noexcept;
+	i32 get_lod_hysteresis() const noexcept;
+
+	void set_lod_morph_enabled(bool enabled) noexcept;
+	bool get_lod_morph_enabled() const noexcept;
+
+	void set_lod_morph_range(f64 chunks) noexcept;
+	f64 get_lod_morph_range() const noexcept;
+
 	void set_water_level(f64 level) noexcept;
 	f64 get_water_level() const noexcept;
 
+	void set_mesh_simplification_enabled(bool enabled) noexcept;
+	bool get_mesh_simplification_enabled() const noexcept;
+
+	void set_mesh_simplification_error(f64 error) noexcept;
+	f64 get_mesh_simplification_error() const noexcept;
+
+	void set_floating_origin_enabled(bool enabled) noexcept;
+	bool get_floating_origin_enabled() const noexcept;
+
+	void set_floating_origin_threshold(f64 threshold) noexcept;
+	f64 get_floating_origin_threshold() const noexcept;
+
+	void set_horizon_occlusion_enabled(bool enabled) noexcept;
+	bool get_horizon_occlusion_enabled() const noexcept;
+
+	void set_horizon_occlusion_margin(f64 margin) noexcept;
+	f64 get_horizon_occlusion_margin() const noexcept;
+
+	i64 get_origin_chunk_x() const noexcept;
+	i64 get_origin_chunk_z() const noexcept;
+
+	Dictionary get_generation_stats() const;
+	void reset_generation_stats() noexcept;
+
+	// Writes the recorded timeline zones as trace-event JSON; builds without trace=yes record nothing.
+	bool save_trace(const String &path) const;
+
 	i32 get_noise_seed() const;
 	void set_noise_seed(i32 v);
 
@@ -143,23 +190,133 @@ public:
 	f64 get_domain_warp_amplitude() const;
 	void set_domain_warp_amplitude(f64 v);
 
+	bool get_erosion_enabled() const;
+	void set_erosion_enabled(bool v);
+
+	i32 get_erosion_region_chunks() const;
+	void set_erosion_region_chunks(i32 v);
+
+	i32 get_erosion_overlap() const;
+	void set_erosion_overlap(i32 v);
+
+	f64 get_erosion_droplet_density() const;
+	void set_erosion_droplet_density(f64 v);
+
+	i32 get_erosion_max_droplets() const;
+	void set_erosion_max_droplets(i32 v);
+
+	i32 get_erosion_thermal_iterations() const;
+	void set_erosion_thermal_iterations(i32 v);
+
+	f64 get_erosion_strength() const;
+	void set_erosion_strength(f64 v);
+
+	bool get_splat_weights_enabled() const;
+	void set_splat_weights_enabled(bool v);
+
+	f64 get_splat_sand_height() const;
+	void set_splat_sand_height(f64 v);
+
+	f64 get_splat_snow_height() const;
+	void set_splat_snow_height(f64 v);
+
+	f64 get_splat_rock_slope() const;
+	void set_splat_rock_slope(f64 v);
+
+	f64 get_splat_blend() const;
+	void set_splat_blend(f64 v);
+
+	f64 get_splat_biome_frequency() const;
+	void set_splat_biome_frequency(f64 v);
+
+	bool get_scatter_enabled() const;
+	void set_scatter_enabled(bool v);
+
+	void set_scatter_mesh(const Ref<Mesh> &mesh);
+	Ref<Mesh> get_scatter_mesh() const;
+
+	f64 get_scatter_density() const;
+	void set_scatter_density(f64 v);
+
+	i32 get_scatter_max_lod() const;
+	void set_scatter_max_lod(i32 v);
+
+	f64 get_scatter_lod_falloff() const;
+	void set_scatter_lod_falloff(f64 v);
+
+	f64 get_scatter_max_slope() const;
+	void set_scatter_max_slope(f64 v);
+
+	f64 get_scatter_min_scale() const;
+	void set_scatter_min_scale(f64 v);
+
+	f64 get_scatter_max_scale() const;
+	void set_scatter_max_scale(f64 v);
+
+	f64 get_scatter_density_frequency() const;
+	void set_scatter_density_frequency(f64 v);
+
 private:
-	[[nodiscard]] MeshInstance3D * generateChunkMesh(const ChunkData& chunkData) const noexcept;
+	[[nodiscard]] MeshInstance3D * generateChunkMesh(const ChunkData& chunkData, const Heightfield& heightfield) noexcept;
+	[[nodiscard]] std::shared_ptr<const Heightfield> acquireHeightfield(const ChunkCoord& coord, TerrainLevelOfDetail lod);
+	[[nodiscard]] std::optional<TerrainLevelOfDetail> residentLod(const ChunkCoord& coord) const;
+	[[nodiscard]] bool isChunkUpToDate(const ChunkCoord& coord, const ChunkEntry& entry, TerrainLevelOfDetail lod) const;
+	void applyCompletedErosion();
+	[[nodiscard]] ChunkMeshSettings makeMeshSettings() const noexcept;
+	[[nodiscard]] bool isScatterActive() const noexcept;
+	void applyCompletedScatter();
+	[[nodiscard]] MultiMeshInstance3D *acquireScatterNode();
+	void recycleScatterNode(MultiMeshInstance3D *scatter);
+	void releaseChunkNode(ChunkEntry &entry);
+	void buildChunkNode(const ChunkCoord& coord, ChunkEntry& entry);
+	void updateHorizonOcclusion();
 	[[nodiscard]] ChunkCoord chunkFromWorld(const Vector3& worldPosition) const noexcept;
-	void onCenterChunkChanged(const ChunkCoord& center);
-	[[nodiscard]] TerrainLevelOfDetail lodForDistance(int dist_chunks) const noexcept;
-	void enqueueNeededChunks(const ChunkCoord &center);
-	void resolvePlayerNode();
+	void onViewerCentersChanged();
+	[[nodiscard]] StreamingSettings makeStreamingSettings() const noexcept;
+	void resolveViewerNodes();
+	void collectViewers();
+	void updateFloatingOrigin();
+	void openBakedArchive();
 
 private:
-	// Noise generator
-	std::unique_ptr<NoiseGenerator> noiseGenerator_;
+	// Noise generator. Rebuilt rather than reconfigured in _ready, worker tasks keep their own reference.
+	std::shared_ptr<const NoiseGenerator> noiseGenerator_;
 	NoiseSettings noiseSettings_;
 
+private:
+	// Splat weights
+	SplatSettings splatSettings_;
+	std::unique_ptr<NoiseGenerator> biomeNoise_;
+
+private:
+	// Scatter
+	ScatterSettings scatterSettings_;
+	Ref<Mesh> scatterMesh_;
+	std::shared_ptr<const NoiseGenerator> scatterDensityNoise_;
+	ScatterScheduler scatterScheduler_;
+	std::vector<ScatterData> completedScatter_;
+	std::vector<MultiMeshInstance3D *> scatterPool_; // detached nodes kept for reuse
+
+private:
+	// Erosion post-process and heightfields
+	ErosionSettings erosionSettings_;
+	ErosionRegionCache erosionRegions_;
+	HeightfieldCache heightfieldCache_;
+	std::vector<ChunkCoord> completedRegions_;
+	std::vector<std::shared_ptr<const ErodedRegion>> chunkRegions_; // regions the chunk being sampled blends from
+
+private:
+	// Pre-baked chunks, used instead of generating wherever the archive covers them
+	String baked_archive_path_;
+	std::unique_ptr<TerrainArchive> bakedArchive_;
+	bool bakedMeshes_ = false; // baked LOD0 meshes match the current mesh settings
+
 private:
 	Ref<Material> terrain_material_;
     NodePath player_path_;
-    Node3D *player_ = nullptr; // cached (not owned)
+    TypedArray<NodePath> viewer_paths_;
+    std::vector<u64> viewerIds_;      // player first, then viewer_nodes; ids so freed viewers drop out
+    std::vector<Node3D *> liveViewers_; // resolved each frame (not owned)
 
 private:
 	// Tile information
@@ -167,22 +324,55 @@ private:
 	f64 tileHeight_;
 	u16 chunkSize_;
 	f64 waterLevel_;
+	bool simplifyMesh_ = false;
+	f64 simplifyError_ = 0.05;
 
 private:
 	i32 viewRadius_ = 8;
 	i32 unloadRadius_ = 12;
 	i32 chunksPerFrame_ = 5;
+	bool heightfieldOnly_ = false; // headless servers: stream heightfields, never build meshes or nodes
 
 	i32 lodLevel0Distance_ = 2;
 	i32 lodLevel1Distance_ = 4;
 	i32 lodLevel2Distance_ = 7;
+	i32 lodHysteresis_ = 1;
+	bool lodMorph_ = false;
+	f64 lodMorphRange_ = 1.0; // chunks before the ring edge where morphing starts
 
 private:
 	// Chunks
 	std::unordered_map<ChunkCoord, ChunkEntry, ChunkCoordHash> chunks_;
 	std::deque<BuildRequest> chunkBuildQueue_;
-	ChunkCoord currentChunkCenter_;
-	bool has_center_ = false;
+	ChunkStreamer streamer_;
+	std::vector<BuildRequest> plannedBuilds_;
+	std::vector<ChunkCoord> viewerCenters_;
+	std::vector<ChunkCoord> scratchCenters_;
+	std::vector<ChunkCoord> regionCenters_;
+	ChunkCoord originChunk_{0, 0}; // chunk sitting at the local origin
+	bool floatingOrigin_ = false;
+	f64 floatingOriginThreshold_ = 2048.0;
+	std::vector<ChunkCoord> pendingMeshes_; // heightfields waiting for their mesh, nearest first
+	ChunkMeshData meshData_;                 // reused by generateChunkMesh, keeps its capacity
+	u32 nextBuildId_ = 0;
+	GenerationStats stats_;
+
+private:
+	// Horizon occlusion
+	bool horizonOcclusion_ = false;
+	f64 horizonOcclusionMargin_ = 2.0; // world units added to chunk tops, also covers cameras above their viewer node
+	HorizonOcclusion horizon_;
+	std::vector<OcclusionBox> occlusionBoxes_;
+	std::vector<ChunkEntry *> occlusionEntries_;
+	std::vector<u8> occlusionScratch_;
+	std::vector<u8> occlusionHidden_;
+	std::vector<Vector3> occlusionEyes_; // eyes of the last pass
+	std::vector<Vector3> occlusionEyeScratch_;
+	bool occlusionDirty_ = true; // chunk bounds or settings changed since the last pass
+
+private:
+	// Declared last so running tasks finish before the state they reference is destroyed.
+	std::unique_ptr<WorkerPool> workerPool_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "trace.h"
+
+#ifdef TERRAIN_TRACE
+
+// std
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// A long session at 60 fps records well under this per thread; beyond it zones are dropped.
+constexpr size_t maxEventsPerThread = size_t(1) << 22;
+
+struct TraceEvent
+{
+    const char *name;
+    u64 startUs;
+    u64 durationUs;
+};
+
+// Each thread appends to its own buffer; the lock is only contended while writing the file.
+struct ThreadBuffer
+{
+    u32 tid = 0;
+    const char *name = nullptr;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    u64 dropped = 0;
+};
+
+struct TraceRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads; // kept past thread exit
+    Clock::time_point epoch = Clock::now();
+};
+
+TraceRegistry& registry()
+{
+    static TraceRegistry instance;
+    return instance;
+}
+
+ThreadBuffer& localBuffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        TraceRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(std::make_unique<ThreadBuffer>());
+        buffer = r.threads.back().get();
+        buffer->tid = static_cast<u32>(r.threads.size());
+    }
+    return *buffer;
+}
+
+[[nodiscard]] u64 nowUs() noexcept
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - registry().epoch).count());
+}
+
+}
+
+TraceZone::TraceZone(const char *name) noexcept
+: name_(name)
+, startUs_(nowUs())
+{
+}
+
+TraceZone::~TraceZone()
+{
+    const u64 end = nowUs();
+    ThreadBuffer& buffer = localBuffer();
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= maxEventsPerThread) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back(TraceEvent{ name_, startUs_, end - startUs_ });
+}
+
+void traceSetThreadName(const char *name)
+{
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+bool traceWrite(const std::string& path)
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() -> const char * {
+        const char *s = first ? "" : ",\n";
+        first = false;
+        return s;
+    };
+
+    for (const std::unique_ptr<ThreadBuffer>& thread : r.threads) {
+        std::lock_guard<std::mutex> thread_lock(thread->mutex);
+
+        if (thread->name) {
+            out << separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid
+                << ",\"args\":{\"name\":\"" << thread->name << "\"}}";
+        }
+        if (thread->dropped > 0) {
+            out << separator() << "{\"name\":\"zones dropped\",\"ph\":\"C\",\"pid\":1,\"tid\":" << thread->tid
+                << ",\"ts\":0,\"args\":{\"count\":" << thread->dropped << "}}";
+        }
+        for (const TraceEvent& e : thread->events) {
+            out << separator() << "{\"name\":\"" << e.name << "\",\"cat\":\"terrain\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->tid
+                << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void traceClear()
+{
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<ThreadBuffer>& thread : r.threads) {
+        std::lock_guard<std::mutex> thread_lock(thread->mutex);
+        thread->events.clear();
+        thread->dropped = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "utils.h"
+
+// Scoped timeline zones, written as trace-event JSON for chrome://tracing or Perfetto. They are only
+// compiled in with TERRAIN_TRACE defined (scons trace=yes); otherwise every macro expands to nothing.
+//
+//   TRACE_ZONE("sample heightfield"); // from here to the end of the scope
+//
+// Zone and thread names must be string literals or otherwise outlive the trace.
+
+#ifdef TERRAIN_TRACE
+
+// std
+#include <string>
+
+class TraceZone
+{
+
+public:
+    explicit TraceZone(const char *name) noexcept;
+    ~TraceZone();
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char *name_;
+    u64 startUs_;
+};
+
+// Labels the calling thread in the timeline.
+void traceSetThreadName(const char *name);
+
+// Writes every zone recorded so far, across all threads. Recording continues afterwards.
+[[nodiscard]] bool traceWrite(const std::string& path);
+
+// Drops the zones recorded so far, e.g. to trace only a level after loading it.
+void traceClear();
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) const TraceZone TRACE_CONCAT(trace_zone_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) traceSetThreadName(name)
+
+#else
+
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
@@ -0,0 +1,85 @@
+#include "worker_pool.h"
+#include "trace.h"
+
+WorkerPool::WorkerPool(u32 threadCount)
+{
+    if (threadCount == 0) {
+        // Leave one core for the main thread.
+        const u32 hw = std::thread::hardware_concurrency();
+        threadCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    threads_.reserve(threadCount);
+    for (u32 i = 0; i < threadCount; i++) {
+        threads_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        // Pending work is dropped, only tasks already running are finished.
+        tasks_.clear();
+    }
+    wake_.notify_all();
+
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        tasks_.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+    std::mutex done_mutex;
+    std::condition_variable done;
+    size_t remaining = count;
+
+    for (size_t i = 0; i < count; i++) {
+        submit([&, i]() {
+            task(i);
+
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--remaining == 0) done.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&]() { return remaining == 0; });
+}
+
+u32 WorkerPool::threadCount() const noexcept
+{
+    return static_cast<u32>(threads_.size());
+}
+
+void WorkerPool::workerLoop()
+{
+    TRACE_THREAD_NAME("terrain worker");
+
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty()) return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        TRACE_ZONE("worker task");
+        task();
+    }
+}
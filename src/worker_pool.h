@@ -0,0 +1,42 @@
+#pragma once
+
+#include "utils.h"
+
+// std
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed-size thread pool for generation work that must stay off the main thread.
+// Tasks must not touch Godot objects; they hand plain data back to the main thread.
+class WorkerPool
+{
+
+public:
+    explicit WorkerPool(u32 threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+public:
+    void submit(std::function<void()> task);
+
+    // Runs task(i) for every i in [0, count) on the workers and blocks until all have finished.
+    // For offline tools; a running game must never block its main thread on this.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+    [[nodiscard]] u32 threadCount() const noexcept;
+
+private:
+    void workerLoop();
+
+private:
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
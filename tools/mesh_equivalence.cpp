@@ -0,0 +1,292 @@
+// Checks buildChunkMesh against a straightforward reference builder: normals scattered over every
+// triangle of the uniform grid, submerged quads merged quad by quad, and every chunk taking the
+// generic vertex remap. The optimized kernels (gathered face normals, the sized plain-grid index
+// write, the identity fast path for dry grids) have to reproduce it bit for bit.
+//
+//   mesh_equivalence [--verbose]
+//
+// Covers chunk sizes 16/24/32/64/128, LOD 0-3, simplify on and off, dry, mixed and submerged water
+// levels and two tile widths. Simplified chunks reuse the builder's quadtree triangles, which the
+// kernels do not touch, and check everything derived from them. Exits with 1 on any mismatch.
+
+#include "heightfield.h"
+#include "chunk_mesh_builder.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Smooth hills with some finer detail, so quadtree leaves come in every size.
+void fillHeightfield(Heightfield& heightfield, u16 chunkSize, TerrainLevelOfDetail lod)
+{
+    heightfield.layout = chunkGridLayout(chunkSize, lod);
+
+    const i32 verts_per_side = heightfield.layout.vertsPerSide;
+    const i32 step = heightfield.layout.step;
+    heightfield.samples.resize(static_cast<size_t>(verts_per_side) * verts_per_side);
+
+    for (i32 vz = 0; vz < verts_per_side; vz++) {
+        for (i32 vx = 0; vx < verts_per_side; vx++) {
+            const f32 x = static_cast<f32>(vx * step);
+            const f32 z = static_cast<f32>(vz * step);
+            heightfield.samples[static_cast<size_t>(vz) * verts_per_side + vx] =
+                0.4f + 0.25f * std::sin(0.11f * x) * std::cos(0.07f * z) + 0.04f * std::sin(1.3f * x + 0.7f * z);
+        }
+    }
+    updateHeightfieldBounds(heightfield);
+}
+
+// Area weighted normals, accumulated triangle by triangle.
+void referenceNormals(const std::vector<f32>& heights, i32 verts_per_side, f32 quad_size, std::vector<f32>& normals)
+{
+    const i32 squares_per_side = verts_per_side - 1;
+    normals.assign(heights.size() * 3, 0.0f);
+
+    auto accumulate = [&](i32 ia, i32 ib, i32 ic, f32 ax, f32 az, f32 bx, f32 bz, f32 cx, f32 cz) {
+        const f32 abx = bx - ax, aby = heights[ib] - heights[ia], abz = bz - az;
+        const f32 acx = cx - ax, acy = heights[ic] - heights[ia], acz = cz - az;
+
+        const f32 nx = aby * acz - abz * acy;
+        const f32 ny = abz * acx - abx * acz;
+        const f32 nz = abx * acy - aby * acx;
+
+        for (const i32 v : { ia, ib, ic }) {
+            normals[v * 3 + 0] += nx;
+            normals[v * 3 + 1] += ny;
+            normals[v * 3 + 2] += nz;
+        }
+    };
+
+    for (i32 z = 0; z < squares_per_side; z++) {
+        const f32 z0 = static_cast<f32>(z) * quad_size;
+        const f32 z1 = static_cast<f32>(z + 1) * quad_size;
+        for (i32 x = 0; x < squares_per_side; x++) {
+            const f32 x0 = static_cast<f32>(x) * quad_size;
+            const f32 x1 = static_cast<f32>(x + 1) * quad_size;
+
+            const i32 v00 = z * verts_per_side + x;
+            const i32 v10 = v00 + 1;
+            const i32 v01 = v00 + verts_per_side;
+            const i32 v11 = v01 + 1;
+
+            accumulate(v00, v11, v01, x0, z0, x1, z1, x0, z1);
+            accumulate(v00, v10, v11, x0, z0, x1, z0, x1, z1);
+        }
+    }
+
+    for (size_t i = 0; i < normals.size(); i += 3) {
+        f32* n = &normals[i];
+        const f32 len2 = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+        if (len2 > 0.000001f) {
+            const f32 inv = 1.0f / std::sqrt(len2);
+            n[0] *= inv;
+            n[1] *= inv;
+            n[2] *= inv;
+        } else {
+            n[0] = 0.0f;
+            n[1] = 1.0f;
+            n[2] = 0.0f;
+        }
+    }
+}
+
+// Grid triangles with submerged quads greedily merged into flat rectangles.
+void referenceTriangulation(const Heightfield& heightfield, f32 water, std::vector<i32>& indices)
+{
+    const i32 squares_per_side = heightfield.layout.squaresPerSide;
+    const i32 verts_per_side = heightfield.layout.vertsPerSide;
+
+    auto emitRect = [&](i32 x0, i32 z0, i32 x1, i32 z1) {
+        const i32 v00 = z0 * verts_per_side + x0;
+        const i32 v10 = z0 * verts_per_side + x1;
+        const i32 v01 = z1 * verts_per_side + x0;
+        const i32 v11 = z1 * verts_per_side + x1;
+        indices.insert(indices.end(), { v00, v11, v01, v00, v10, v11 });
+    };
+
+    indices.clear();
+    if (heightfield.maxSample <= water) {
+        if (squares_per_side > 0) emitRect(0, 0, squares_per_side, squares_per_side);
+        return;
+    }
+
+    const size_t quad_count = static_cast<size_t>(squares_per_side) * squares_per_side;
+    std::vector<u8> submerged(quad_count, 0);
+    std::vector<u8> consumed(quad_count, 0);
+
+    for (i32 z = 0; z < squares_per_side; z++) {
+        for (i32 x = 0; x < squares_per_side; x++) {
+            const f32 top = std::max(
+                std::max(heightfield.at(x, z), heightfield.at(x + 1, z)),
+                std::max(heightfield.at(x, z + 1), heightfield.at(x + 1, z + 1)));
+            submerged[static_cast<size_t>(z) * squares_per_side + x] = top <= water ? 1 : 0;
+        }
+    }
+
+    auto mergeable = [&](i32 x, i32 z) {
+        const size_t q = static_cast<size_t>(z) * squares_per_side + x;
+        return submerged[q] && !consumed[q];
+    };
+
+    for (i32 z = 0; z < squares_per_side; z++) {
+        for (i32 x = 0; x < squares_per_side; x++) {
+            const size_t q = static_cast<size_t>(z) * squares_per_side + x;
+            if (consumed[q]) continue;
+
+            if (!submerged[q]) {
+                emitRect(x, z, x + 1, z + 1);
+                continue;
+            }
+
+            i32 x1 = x + 1;
+            while (x1 < squares_per_side && mergeable(x1, z)) x1++;
+
+            i32 z1 = z + 1;
+            for (; z1 < squares_per_side; z1++) {
+                bool row = true;
+                for (i32 rx = x; rx < x1 && row; rx++) row = mergeable(rx, z1);
+                if (!row) break;
+            }
+
+            for (i32 rz = z; rz < z1; rz++) {
+                for (i32 rx = x; rx < x1; rx++) {
+                    consumed[static_cast<size_t>(rz) * squares_per_side + rx] = 1;
+                }
+            }
+
+            emitRect(x, z, x1, z1);
+        }
+    }
+}
+
+[[nodiscard]] bool isPowerOfTwo(i32 v) noexcept {
+    return v > 0 && (v & (v - 1)) == 0;
+}
+
+// What buildChunkMesh produced before the kernels were restructured. quadtree holds the grid ids of
+// the builder's simplified triangles, used instead of the plain triangulation when it simplified.
+void buildReferenceMesh(const Heightfield& heightfield, const ChunkMeshSettings& settings, const std::vector<i32>& quadtree, ChunkMeshData& out)
+{
+    const i32 squares_per_side = heightfield.layout.squaresPerSide;
+    const i32 verts_per_side = heightfield.layout.vertsPerSide;
+    const i32 grid_count = verts_per_side * verts_per_side;
+    const f32 water = static_cast<f32>(settings.waterLevel);
+    const f32 quad_size = static_cast<f32>(settings.tileWidth) * static_cast<f32>(heightfield.layout.step);
+
+    std::vector<f32> heights(static_cast<size_t>(grid_count));
+    for (i32 i = 0; i < grid_count; i++) {
+        const f64 sample = std::max(static_cast<f64>(heightfield.samples[i]), settings.waterLevel);
+        heights[i] = static_cast<f32>(sample * settings.tileHeight);
+    }
+
+    std::vector<f32> grid_normals;
+    referenceNormals(heights, verts_per_side, quad_size, grid_normals);
+
+    out.clear();
+    out.uniformTriangleCount = static_cast<u32>(squares_per_side) * static_cast<u32>(squares_per_side) * 2u;
+
+    if (settings.simplify && isPowerOfTwo(squares_per_side) && heightfield.maxSample > water) {
+        out.indices = quadtree;
+    } else {
+        referenceTriangulation(heightfield, water, out.indices);
+    }
+
+    std::vector<i32> remap(static_cast<size_t>(grid_count), -1);
+    for (const i32 g : out.indices) remap[g] = 0;
+    for (i32 g = 0; g < grid_count; g++) {
+        if (remap[g] < 0) continue;
+        remap[g] = static_cast<i32>(out.gridIndices.size());
+        out.gridIndices.push_back(g);
+    }
+    for (i32& index : out.indices) index = remap[index];
+
+    const f32 uv_scale = verts_per_side > 1 ? 1.0f / static_cast<f32>(verts_per_side - 1) : 0.0f;
+    for (const i32 g : out.gridIndices) {
+        const i32 vx = g % verts_per_side;
+        const i32 vz = g / verts_per_side;
+        out.positions.insert(out.positions.end(), { static_cast<f32>(vx) * quad_size, heights[g], static_cast<f32>(vz) * quad_size });
+        out.normals.insert(out.normals.end(), { grid_normals[g * 3 + 0], grid_normals[g * 3 + 1], grid_normals[g * 3 + 2] });
+        out.uvs.insert(out.uvs.end(), { static_cast<f32>(vx) * uv_scale, static_cast<f32>(vz) * uv_scale });
+    }
+}
+
+// First array that differs, or null when the meshes are identical.
+[[nodiscard]] const char *firstDifference(const ChunkMeshData& a, const ChunkMeshData& b)
+{
+    if (a.uniformTriangleCount != b.uniformTriangleCount) return "uniformTriangleCount";
+    if (a.gridIndices != b.gridIndices) return "gridIndices";
+    if (a.indices != b.indices) return "indices";
+    if (a.positions != b.positions) return "positions";
+    if (a.normals != b.normals) return "normals";
+    if (a.uvs != b.uvs) return "uvs";
+    return nullptr;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--verbose") {
+            verbose = true;
+        } else {
+            std::fprintf(stderr, "usage: mesh_equivalence [--verbose]\n");
+            return 1;
+        }
+    }
+
+    u32 cases = 0;
+    u32 mismatches = 0;
+
+    for (const u16 chunk_size : { 16, 24, 32, 64, 128 }) {
+        for (const TerrainLevelOfDetail lod : { TerrainLevelOfDetail::LEVEL_0, TerrainLevelOfDetail::LEVEL_1,
+                                                TerrainLevelOfDetail::LEVEL_2, TerrainLevelOfDetail::LEVEL_3 }) {
+            Heightfield heightfield;
+            fillHeightfield(heightfield, chunk_size, lod);
+
+            for (const bool simplify : { false, true }) {
+                for (const f64 water : { -1.0, 0.35, 2.0 }) { // dry, mixed, submerged
+                    for (const f64 tile_width : { 1.0, 0.37 }) {
+                        ChunkMeshSettings settings;
+                        settings.chunkSize = chunk_size;
+                        settings.tileWidth = tile_width;
+                        settings.tileHeight = 37.0;
+                        settings.waterLevel = water;
+                        settings.simplify = simplify;
+                        settings.simplifyError = 0.5f;
+
+                        ChunkMeshData built;
+                        buildChunkMesh(heightfield, settings, nullptr, built);
+
+                        std::vector<i32> quadtree(built.indices.size());
+                        for (size_t i = 0; i < quadtree.size(); i++) {
+                            quadtree[i] = built.gridIndices[built.indices[i]];
+                        }
+
+                        ChunkMeshData reference;
+                        buildReferenceMesh(heightfield, settings, quadtree, reference);
+
+                        cases++;
+                        const char *difference = firstDifference(built, reference);
+                        if (difference) mismatches++;
+                        if (difference || verbose) {
+                            std::printf("chunk_size %u lod %d simplify %d water %g tile_width %g: %s\n",
+                                        static_cast<unsigned>(chunk_size), static_cast<int>(lod), simplify ? 1 : 0,
+                                        water, tile_width, difference ? difference : "ok");
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::printf("%u cases, %u mismatches\n", cases, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
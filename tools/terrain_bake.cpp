@@ -0,0 +1,291 @@
+// Offline bake of a rectangle of terrain chunks into a tiled, compressed archive that
+// TerrainGenerator loads instead of generating (see baked_archive). Uses the same Godot-free
+// heightfield, erosion and mesh code as the runtime, spread over every core.
+//
+//   terrain_bake --out world.tgar --min-x -64 --min-z -64 --chunks-x 128 --chunks-z 128 [options]
+//
+// Noise, erosion and tile settings must match the TerrainGenerator that loads the archive; it
+// ignores archives whose settings hash differs from its own. Every noise setting the node exposes
+// has an option; the rest keep their NoiseSettings defaults, as they do on the node.
+
+#include "heightfield.h"
+#include "chunk_mesh_builder.h"
+#include "terrain_erosion.h"
+#include "terrain_archive.h"
+#include "worker_pool.h"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct BakeOptions
+{
+    std::string out;
+    TerrainArchiveHeader header;
+    NoiseSettings noise;
+    ErosionSettings erosion;
+    bool simplify = false;
+    u32 threads = 0;
+};
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: terrain_bake --out FILE --chunks-x N --chunks-z N [options]\n"
+        "  --min-x N --min-z N           first chunk of the rectangle (0)\n"
+        "  --chunk-size N                tiles per chunk side (32)\n"
+        "  --tile-width F --tile-height F  (1.0, 10.0)\n"
+        "  --water-level F               (0.0)\n"
+        "  --tile-chunks N               chunks per archive tile side (8)\n"
+        "  --seed N --noise-type N --frequency F --fractal-type N\n"
+        "  --octaves N --lacunarity F --gain F\n"
+        "  --domain-warp                 enable domain warp\n"
+        "  --domain-warp-amp F\n"
+        "  --erosion                     erode by region before baking\n"
+        "  --region-chunks N --erosion-overlap N --droplet-density F\n"
+        "  --max-droplets N --thermal-iterations N --erosion-strength F\n"
+        "  --meshes                      also store LOD0 meshes\n"
+        "  --simplify-error F            simplify stored meshes with this error\n"
+        "  --threads N                   worker threads (all cores)\n");
+}
+
+// Same mapping as TerrainGenerator::set_noise_type, so archives match the node's settings.
+[[nodiscard]] FastNoiseLite::NoiseType noiseTypeFromIndex(i32 v) noexcept
+{
+    switch (v) {
+        case NOISE_PERLIN:
+            return FastNoiseLite::NoiseType_Perlin;
+        case NOISE_CELLULAR:
+            return FastNoiseLite::NoiseType_Cellular;
+        default:
+            return FastNoiseLite::NoiseType_OpenSimplex2;
+    }
+}
+
+[[nodiscard]] bool parseOptions(int argc, char **argv, BakeOptions& o)
+{
+    const std::unordered_set<std::string> switches = { "--erosion", "--meshes", "--domain-warp" };
+    std::unordered_map<std::string, std::string> values;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string key = argv[i];
+        if (switches.count(key)) {
+            values[key] = "1";
+        } else if (key.rfind("--", 0) == 0 && i + 1 < argc) {
+            values[key] = argv[++i];
+        } else {
+            std::fprintf(stderr, "terrain_bake: unexpected argument '%s'\n", key.c_str());
+            return false;
+        }
+    }
+
+    auto text = [&](const char *key, const std::string& fallback) {
+        auto it = values.find(key);
+        return it != values.end() ? it->second : fallback;
+    };
+    auto integer = [&](const char *key, i64 fallback) {
+        auto it = values.find(key);
+        return it != values.end() ? std::strtoll(it->second.c_str(), nullptr, 10) : fallback;
+    };
+    auto real = [&](const char *key, f64 fallback) {
+        auto it = values.find(key);
+        return it != values.end() ? std::strtod(it->second.c_str(), nullptr) : fallback;
+    };
+
+    o.out = text("--out", "");
+
+    TerrainArchiveHeader& h = o.header;
+    h.minChunkX = integer("--min-x", 0);
+    h.minChunkZ = integer("--min-z", 0);
+    h.chunksX = static_cast<i32>(integer("--chunks-x", 0));
+    h.chunksZ = static_cast<i32>(integer("--chunks-z", 0));
+    h.chunkSize = static_cast<u16>(std::clamp<i64>(integer("--chunk-size", 32), 1, 65535));
+    h.tileChunks = static_cast<u16>(std::clamp<i64>(integer("--tile-chunks", 8), 1, 256));
+    h.tileWidth = real("--tile-width", 1.0);
+    h.tileHeight = real("--tile-height", 10.0);
+    h.waterLevel = real("--water-level", 0.0);
+    h.hasMeshes = values.count("--meshes") > 0;
+
+    NoiseSettings& n = o.noise;
+    n.seed = static_cast<i32>(integer("--seed", n.seed));
+    n.noise_type = noiseTypeFromIndex(static_cast<i32>(integer("--noise-type", NOISE_OPENSIMPLEX2)));
+    n.frequency = static_cast<f32>(real("--frequency", n.frequency));
+    n.fractal_type = static_cast<FastNoiseLite::FractalType>(integer("--fractal-type", static_cast<i64>(n.fractal_type)));
+    n.octaves = static_cast<i32>(integer("--octaves", n.octaves));
+    n.lacunarity = static_cast<f32>(real("--lacunarity", n.lacunarity));
+    n.gain = static_cast<f32>(real("--gain", n.gain));
+    n.domain_warp_enabled = values.count("--domain-warp") > 0;
+    n.domain_warp_amp = static_cast<f32>(real("--domain-warp-amp", n.domain_warp_amp));
+    h.seed = n.seed;
+
+    ErosionSettings& e = o.erosion;
+    e.enabled = values.count("--erosion") > 0;
+    e.region_chunks = static_cast<i32>(std::max<i64>(1, integer("--region-chunks", e.region_chunks)));
+    e.overlap = static_cast<i32>(std::max<i64>(0, integer("--erosion-overlap", e.overlap)));
+    e.droplet_density = static_cast<f32>(std::max(0.0, real("--droplet-density", e.droplet_density)));
+    e.max_droplets = static_cast<i32>(std::max<i64>(0, integer("--max-droplets", e.max_droplets)));
+    e.thermal_iterations = static_cast<i32>(std::max<i64>(0, integer("--thermal-iterations", e.thermal_iterations)));
+    e.strength = static_cast<f32>(std::clamp(real("--erosion-strength", e.strength), 0.0, 1.0));
+    h.eroded = e.enabled;
+    h.generationHash = terrainGenerationHash(n, e);
+
+    if (values.count("--simplify-error")) {
+        o.simplify = true;
+        h.simplifyError = static_cast<f32>(std::max(0.0, real("--simplify-error", 0.05)));
+    }
+
+    o.threads = static_cast<u32>(std::max<i64>(0, integer("--threads", 0)));
+
+    if (o.out.empty() || h.chunksX <= 0 || h.chunksZ <= 0) {
+        std::fprintf(stderr, "terrain_bake: --out, --chunks-x and --chunks-z are required\n");
+        return false;
+    }
+    return true;
+}
+
+[[nodiscard]] f64 secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<f64>(Clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    BakeOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    const TerrainArchiveHeader& header = options.header;
+
+    NoiseGenerator noise;
+    noise.applySettings(options.noise);
+
+    // The main thread only waits, so every core can work.
+    const u32 hw = std::max(1u, std::thread::hardware_concurrency());
+    WorkerPool pool(options.threads > 0 ? options.threads : hw);
+
+    const Clock::time_point start = Clock::now();
+
+    // 1) Erode every region touching the rectangle, plus the ring around it that border chunks blend
+    // from; chunks are cut out of them afterwards.
+    const i32 region_chunks = options.erosion.region_chunks;
+    const i64 region_x0 = floorDiv(header.minChunkX, region_chunks) - 1;
+    const i64 region_z0 = floorDiv(header.minChunkZ, region_chunks) - 1;
+    const i64 regions_x = floorDiv(header.minChunkX + header.chunksX - 1, region_chunks) + 1 - region_x0 + 1;
+    const i64 regions_z = floorDiv(header.minChunkZ + header.chunksZ - 1, region_chunks) + 1 - region_z0 + 1;
+
+    std::vector<std::shared_ptr<const ErodedRegion>> regions;
+    if (options.erosion.enabled) {
+        regions.resize(static_cast<size_t>(regions_x * regions_z));
+        pool.parallelFor(regions.size(), [&](size_t i) {
+            const ChunkCoord region{ region_x0 + static_cast<i64>(i) % regions_x, region_z0 + static_cast<i64>(i) / regions_x };
+            regions[i] = erodeRegion(noise, region, options.erosion, header.chunkSize, header.tileWidth, header.tileHeight, header.seed);
+        });
+    }
+    const f64 erosion_seconds = secondsSince(start);
+
+    // 2) Sample, optionally mesh, and encode tile by tile; a tile's chunks are dropped once encoded.
+    ChunkMeshSettings mesh_settings;
+    mesh_settings.chunkSize = header.chunkSize;
+    mesh_settings.tileWidth = header.tileWidth;
+    mesh_settings.tileHeight = header.tileHeight;
+    mesh_settings.waterLevel = header.waterLevel;
+    mesh_settings.simplify = options.simplify;
+    mesh_settings.simplifyError = header.simplifyError;
+
+    const i32 tile_chunks = header.tileChunks;
+    std::vector<std::vector<u8>> tiles(static_cast<size_t>(header.tilesX()) * header.tilesZ());
+    std::vector<u64> tile_triangles(tiles.size(), 0);
+
+    pool.parallelFor(tiles.size(), [&](size_t t) {
+        const i64 tile_x = static_cast<i64>(t) % header.tilesX();
+        const i64 tile_z = static_cast<i64>(t) / header.tilesX();
+
+        std::vector<BakedChunk> chunks(static_cast<size_t>(tile_chunks) * tile_chunks);
+        std::vector<ChunkCoord> chunk_regions;
+        std::vector<std::shared_ptr<const ErodedRegion>> eroded;
+        std::vector<const BakedChunk*> slots(chunks.size(), nullptr);
+
+        for (i32 sz = 0; sz < tile_chunks; sz++) {
+            for (i32 sx = 0; sx < tile_chunks; sx++) {
+                const ChunkCoord coord{
+                    header.minChunkX + tile_x * tile_chunks + sx,
+                    header.minChunkZ + tile_z * tile_chunks + sz
+                };
+                if (!header.contains(coord)) continue;
+
+                const size_t slot = static_cast<size_t>(sz) * tile_chunks + sx;
+                BakedChunk& chunk = chunks[slot];
+
+                if (options.erosion.enabled) {
+                    erosionRegionsForChunk(coord, options.erosion, header.chunkSize, chunk_regions);
+                    eroded.clear();
+                    for (const ChunkCoord& r : chunk_regions) {
+                        eroded.push_back(regions[static_cast<size_t>((r.z - region_z0) * regions_x + (r.x - region_x0))]);
+                    }
+                    chunk.heightfield = sampleHeightfieldFromRegions(eroded, coord, TerrainLevelOfDetail::LEVEL_0, header.chunkSize);
+                } else {
+                    chunk.heightfield = sampleHeightfield(noise, coord, TerrainLevelOfDetail::LEVEL_0, header.chunkSize, header.tileWidth);
+                }
+
+                if (header.hasMeshes) {
+                    buildChunkMesh(*chunk.heightfield, mesh_settings, nullptr, chunk.mesh);
+                    tile_triangles[t] += chunk.mesh.triangleCount();
+                }
+
+                slots[slot] = &chunk;
+            }
+        }
+
+        encodeArchiveTile(header, slots, tiles[t]);
+    });
+
+    const f64 bake_seconds = secondsSince(start);
+
+    std::ofstream file(options.out, std::ios::binary | std::ios::trunc);
+    if (!file || !writeTerrainArchive(file, header, tiles)) {
+        std::fprintf(stderr, "terrain_bake: could not write '%s'\n", options.out.c_str());
+        return 1;
+    }
+    const u64 archive_bytes = static_cast<u64>(file.tellp());
+    file.close();
+
+    const u64 chunk_count = static_cast<u64>(header.chunksX) * static_cast<u64>(header.chunksZ);
+    const u64 verts_per_side = static_cast<u64>(header.chunkSize) + 1;
+    const u64 raw_height_bytes = chunk_count * verts_per_side * verts_per_side * sizeof(f32);
+    u64 triangles = 0;
+    for (u64 n : tile_triangles) triangles += n;
+
+    std::printf("baked %llu chunks (%d x %d) into %zu tiles on %u threads\n",
+                static_cast<unsigned long long>(chunk_count), header.chunksX, header.chunksZ, tiles.size(), pool.threadCount());
+    if (options.erosion.enabled) {
+        std::printf("erosion:     %.2f s for %zu regions\n", erosion_seconds, regions.size());
+    }
+    std::printf("total:       %.2f s, %.1f chunks/s, %.1f MB/s of raw heights\n",
+                bake_seconds, static_cast<f64>(chunk_count) / bake_seconds,
+                static_cast<f64>(raw_height_bytes) / (1024.0 * 1024.0) / bake_seconds);
+    if (header.hasMeshes) {
+        std::printf("meshes:      %llu triangles\n", static_cast<unsigned long long>(triangles));
+    }
+    std::printf("archive:     %.2f MB (raw f32 heights %.2f MB, %.2fx)\n",
+                static_cast<f64>(archive_bytes) / (1024.0 * 1024.0),
+                static_cast<f64>(raw_height_bytes) / (1024.0 * 1024.0),
+                archive_bytes > 0 ? static_cast<f64>(raw_height_bytes) / static_cast<f64>(archive_bytes) : 0.0);
+    return 0;
+}
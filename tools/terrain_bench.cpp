@@ -0,0 +1,558 @@
+// Regression benchmarks for the Godot-free chunk pipeline: heightfield sampling, mesh building and
+// the streamer's planning, driven the way TerrainGenerator drives them. Results are written as JSON
+// so runs can be kept and compared against a baseline.
+//
+//   terrain_bench --out results.json [--baseline previous.json --tolerance 0.1] [options]
+//
+// With --baseline, a scenario whose throughput drops or whose p99 latency grows by more than the
+// tolerance is reported and the exit code is 2.
+
+#include "heightfield.h"
+#include "chunk_mesh_builder.h"
+#include "chunk_streamer.h"
+#include "scratch_arena.h"
+#include "trace.h"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions
+{
+    std::string out;
+    std::string baseline;
+    std::string trace;    // timeline output, trace=yes builds only
+    f64 tolerance = 0.10;
+    u16 chunkSize = 32;
+    i32 viewRadius = 8;
+    i32 iterations = 256; // chunks per LOD in the single chunk scenario
+    i32 flightSteps = 48; // chunk crossings of the flythrough
+    i32 stormRounds = 8;
+    StreamingSettings streaming;
+    NoiseSettings noise;
+};
+
+struct ScenarioResult
+{
+    std::string name;
+    std::string unit;        // what one latency sample measures
+    u64 items = 0;           // chunks built
+    f64 seconds = 0.0;
+    f64 throughput = 0.0;    // chunks per second
+    f64 p50 = 0.0;           // latency percentiles in milliseconds
+    f64 p90 = 0.0;
+    f64 p99 = 0.0;
+    f64 max = 0.0;
+    i64 rssDeltaKb = 0;      // resident set growth over the timed part, working set still alive
+    u64 scratchPeakBytes = 0; // mesh scratch arena high-water mark of the scenario
+};
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: terrain_bench [options]\n"
+        "  --out FILE                    write JSON results here (stdout)\n"
+        "  --baseline FILE               compare against an earlier result file\n"
+        "  --tolerance F                 allowed relative regression (0.1)\n"
+        "  --chunk-size N                tiles per chunk side (32)\n"
+        "  --view-radius N               chunks (8)\n"
+        "  --lod-distances A,B,C         LOD ring ends in chunks (2,4,7)\n"
+        "  --iterations N                chunks per LOD for single chunk runs (256)\n"
+        "  --flight-steps N              chunk crossings of the flythrough (48)\n"
+        "  --storm-rounds N              settings changes of the storm (8)\n"
+        "  --seed N --frequency F --octaves N\n"
+        "  --trace FILE                  write the timeline (trace=yes builds)\n");
+}
+
+[[nodiscard]] bool parseOptions(int argc, char **argv, BenchOptions& o)
+{
+    std::unordered_map<std::string, std::string> values;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string key = argv[i];
+        if (key.rfind("--", 0) == 0 && i + 1 < argc) {
+            values[key] = argv[++i];
+        } else {
+            std::fprintf(stderr, "terrain_bench: unexpected argument '%s'\n", key.c_str());
+            return false;
+        }
+    }
+
+    auto text = [&](const char *key, const std::string& fallback) {
+        auto it = values.find(key);
+        return it != values.end() ? it->second : fallback;
+    };
+    auto integer = [&](const char *key, i64 fallback) {
+        auto it = values.find(key);
+        return it != values.end() ? std::strtoll(it->second.c_str(), nullptr, 10) : fallback;
+    };
+    auto real = [&](const char *key, f64 fallback) {
+        auto it = values.find(key);
+        return it != values.end() ? std::strtod(it->second.c_str(), nullptr) : fallback;
+    };
+
+    o.out = text("--out", "");
+    o.baseline = text("--baseline", "");
+    o.trace = text("--trace", "");
+    o.tolerance = std::max(0.0, real("--tolerance", o.tolerance));
+    o.chunkSize = static_cast<u16>(std::clamp<i64>(integer("--chunk-size", o.chunkSize), 1, 1024));
+    o.viewRadius = static_cast<i32>(std::clamp<i64>(integer("--view-radius", o.viewRadius), 0, 64));
+    o.iterations = static_cast<i32>(std::max<i64>(1, integer("--iterations", o.iterations)));
+    o.flightSteps = static_cast<i32>(std::max<i64>(1, integer("--flight-steps", o.flightSteps)));
+    o.stormRounds = static_cast<i32>(std::max<i64>(1, integer("--storm-rounds", o.stormRounds)));
+
+    StreamingSettings& s = o.streaming;
+    s.viewRadius = o.viewRadius;
+    s.unloadRadius = o.viewRadius + 2;
+    const std::string lods = text("--lod-distances", "");
+    if (!lods.empty() && std::sscanf(lods.c_str(), "%d,%d,%d", &s.lodLevel0Distance, &s.lodLevel1Distance, &s.lodLevel2Distance) != 3) {
+        std::fprintf(stderr, "terrain_bench: --lod-distances expects three comma separated values\n");
+        return false;
+    }
+
+    NoiseSettings& n = o.noise;
+    n.seed = static_cast<i32>(integer("--seed", n.seed));
+    n.frequency = static_cast<f32>(real("--frequency", n.frequency));
+    n.octaves = static_cast<i32>(integer("--octaves", n.octaves));
+    return true;
+}
+
+[[nodiscard]] f64 millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+}
+
+// Current resident set in KiB; zero where the platform has no cheap way to ask. Not the process
+// high-water mark, which would stick at the largest scenario and hide every later one. Heap freed by
+// an earlier scenario and reused by a later one shows up as no growth there.
+[[nodiscard]] i64 currentRssKb()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    i64 size = 0;
+    i64 resident = 0;
+    if (!(statm >> size >> resident)) return 0;
+    return resident * static_cast<i64>(sysconf(_SC_PAGESIZE)) / 1024;
+#else
+    return 0;
+#endif
+}
+
+[[nodiscard]] f64 percentile(const std::vector<f64>& sorted, f64 p)
+{
+    if (sorted.empty()) return 0.0;
+    const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<f64>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+// rssBeforeKb is currentRssKb() taken where the timed part starts.
+[[nodiscard]] ScenarioResult summarize(const std::string& name, const std::string& unit, u64 items, f64 totalMs, std::vector<f64> latencies, i64 rssBeforeKb)
+{
+    std::sort(latencies.begin(), latencies.end());
+
+    ScenarioResult r;
+    r.name = name;
+    r.unit = unit;
+    r.items = items;
+    r.seconds = totalMs / 1000.0;
+    r.throughput = r.seconds > 0.0 ? static_cast<f64>(items) / r.seconds : 0.0;
+    r.p50 = percentile(latencies, 0.50);
+    r.p90 = percentile(latencies, 0.90);
+    r.p99 = percentile(latencies, 0.99);
+    r.max = latencies.empty() ? 0.0 : latencies.back();
+    r.rssDeltaKb = currentRssKb() - rssBeforeKb;
+
+    ScratchArena& arena = ScratchArena::local();
+    r.scratchPeakBytes = arena.peakBytes();
+    arena.resetStats();
+    return r;
+}
+
+// Resident chunks and the heightfield cache, kept the way TerrainGenerator keeps them.
+class BenchWorld
+{
+
+public:
+    BenchWorld(const BenchOptions& options, const NoiseGenerator& noise)
+    : options_(options), noise_(noise)
+    {
+        streamer_.configure(options.streaming);
+        mesh_.chunkSize = options.chunkSize;
+    }
+
+public:
+    ChunkMeshSettings& meshSettings() noexcept { return mesh_; }
+    HeightfieldCache& cache() noexcept { return cache_; }
+
+    // Samples (or reuses) the heightfield and builds the mesh; returns the time it took.
+    f64 build(const ChunkCoord& coord, TerrainLevelOfDetail lod)
+    {
+        const Clock::time_point start = Clock::now();
+
+        std::shared_ptr<const Heightfield> heightfield = cache_.find(coord, lod);
+        if (!heightfield) {
+            heightfield = sampleHeightfield(noise_, coord, lod, options_.chunkSize, mesh_.tileWidth);
+            cache_.insert(heightfield);
+        }
+
+        buildChunkMesh(*heightfield, mesh_, nullptr, meshData_);
+
+        resident_[coord] = lod;
+        return millisecondsSince(start);
+    }
+
+    // Mirrors TerrainGenerator::onViewerCentersChanged: plan, unload what no viewer references,
+    // then build the plan nearest first. One latency sample per built chunk.
+    void moveViewers(const std::vector<ChunkCoord>& viewers, std::vector<f64>& latencies, u64& built)
+    {
+        planned_.clear();
+        streamer_.planBuilds(viewers, [this](const ChunkCoord& c) {
+            auto it = resident_.find(c);
+            return it != resident_.end() ? std::optional<TerrainLevelOfDetail>(it->second) : std::nullopt;
+        }, [this](const ChunkCoord& c, TerrainLevelOfDetail lod) {
+            auto it = resident_.find(c);
+            return it == resident_.end() || it->second != lod;
+        }, planned_);
+
+        for (auto it = resident_.begin(); it != resident_.end(); ) {
+            if (streamer_.countReferences(it->first, viewers) == 0) {
+                it = resident_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (const BuildRequest& request : planned_) {
+            latencies.push_back(build(request.coord, request.lod));
+            built++;
+        }
+    }
+
+    // Rebuilds every resident chunk at its current LOD, as a settings change does.
+    void rebuildAll(std::vector<f64>& latencies, u64& built)
+    {
+        for (const auto& [coord, lod] : resident_) {
+            latencies.push_back(build(coord, lod));
+            built++;
+        }
+    }
+
+    void clear()
+    {
+        resident_.clear();
+        cache_.clear();
+    }
+
+private:
+    const BenchOptions& options_;
+    const NoiseGenerator& noise_;
+    ChunkMeshSettings mesh_;
+    ChunkStreamer streamer_;
+    HeightfieldCache cache_;
+    std::unordered_map<ChunkCoord, TerrainLevelOfDetail, ChunkCoordHash> resident_;
+    std::vector<BuildRequest> planned_;
+    ChunkMeshData meshData_; // reused like TerrainGenerator's
+};
+
+// Cold builds of single chunks at one LOD, each at a fresh coordinate so nothing is cached.
+ScenarioResult runSingleChunk(BenchWorld& world, const BenchOptions& options, TerrainLevelOfDetail lod)
+{
+    world.clear();
+
+    std::vector<f64> latencies;
+    const i64 rss_before = currentRssKb();
+    const Clock::time_point start = Clock::now();
+    for (i32 i = 0; i < options.iterations; i++) {
+        latencies.push_back(world.build(ChunkCoord{ 1000 + i, -1000 - i }, lod));
+    }
+    const f64 total = millisecondsSince(start);
+
+    world.clear();
+    return summarize("single_chunk_lod" + std::to_string(static_cast<int>(lod)), "chunk", static_cast<u64>(options.iterations), total, std::move(latencies), rss_before);
+}
+
+// Mesh building alone for one chunk size and LOD, over heightfields sampled up front, so the
+// mesh kernels are measured without noise sampling.
+ScenarioResult runMeshKernel(const BenchOptions& options, const NoiseGenerator& noise, u16 chunkSize, TerrainLevelOfDetail lod)
+{
+    constexpr i32 heightfieldCount = 16;
+
+    std::vector<std::shared_ptr<Heightfield>> heightfields;
+    for (i32 i = 0; i < heightfieldCount; i++) {
+        heightfields.push_back(sampleHeightfield(noise, ChunkCoord{ 3 * i, -2 * i }, lod, chunkSize, 1.0));
+    }
+
+    ChunkMeshSettings settings;
+    settings.chunkSize = chunkSize;
+
+    ChunkMeshData data;
+    std::vector<f64> latencies;
+    const i64 rss_before = currentRssKb();
+    const Clock::time_point start = Clock::now();
+    for (i32 i = 0; i < options.iterations; i++) {
+        const Clock::time_point chunk_start = Clock::now();
+        buildChunkMesh(*heightfields[static_cast<size_t>(i % heightfieldCount)], settings, nullptr, data);
+        latencies.push_back(millisecondsSince(chunk_start));
+    }
+    const f64 total = millisecondsSince(start);
+
+    return summarize("mesh_cs" + std::to_string(chunkSize) + "_lod" + std::to_string(static_cast<int>(lod)), "chunk",
+                     static_cast<u64>(options.iterations), total, std::move(latencies), rss_before);
+}
+
+// Everything inside the view radius of one viewer, from nothing.
+ScenarioResult runViewFill(BenchWorld& world)
+{
+    world.clear();
+
+    std::vector<f64> latencies;
+    u64 built = 0;
+    const i64 rss_before = currentRssKb();
+    const Clock::time_point start = Clock::now();
+    world.moveViewers({ ChunkCoord{ 0, 0 } }, latencies, built);
+    const f64 total = millisecondsSince(start);
+
+    return summarize("view_fill", "chunk", built, total, std::move(latencies), rss_before);
+}
+
+// A viewer crossing one chunk per step in a straight line; latency is the whole step, the hitch a
+// frame would see if it built the plan at once.
+ScenarioResult runFlythrough(BenchWorld& world, const BenchOptions& options)
+{
+    world.clear();
+
+    std::vector<f64> ignored;
+    u64 warm = 0;
+    world.moveViewers({ ChunkCoord{ 0, 0 } }, ignored, warm);
+
+    std::vector<f64> steps;
+    std::vector<f64> chunk_latencies;
+    u64 built = 0;
+    const i64 rss_before = currentRssKb();
+    const Clock::time_point start = Clock::now();
+    for (i32 i = 1; i <= options.flightSteps; i++) {
+        const Clock::time_point step_start = Clock::now();
+        world.moveViewers({ ChunkCoord{ i, i / 3 } }, chunk_latencies, built);
+        steps.push_back(millisecondsSince(step_start));
+    }
+    const f64 total = millisecondsSince(start);
+
+    return summarize("flythrough", "step", built, total, std::move(steps), rss_before);
+}
+
+// Alternating mesh-only and noise settings changes over a filled view, each rebuilding every chunk.
+ScenarioResult runSettingsStorm(BenchWorld& world, const BenchOptions& options, NoiseGenerator& noise)
+{
+    world.clear();
+
+    std::vector<f64> ignored;
+    u64 warm = 0;
+    world.moveViewers({ ChunkCoord{ 0, 0 } }, ignored, warm);
+
+    ChunkMeshSettings& mesh = world.meshSettings();
+    const ChunkMeshSettings original = mesh;
+    NoiseSettings noise_settings = options.noise;
+
+    std::vector<f64> latencies;
+    u64 built = 0;
+    const i64 rss_before = currentRssKb();
+    const Clock::time_point start = Clock::now();
+    for (i32 round = 0; round < options.stormRounds; round++) {
+        switch (round % 4) {
+            case 0:
+                mesh.waterLevel = mesh.waterLevel > 0.0 ? 0.0 : 0.3;
+                break;
+            case 1:
+                mesh.simplify = !mesh.simplify;
+                break;
+            case 2:
+                mesh.splat.enabled = !mesh.splat.enabled;
+                break;
+            default:
+                // New noise invalidates every cached heightfield, like set_noise_frequency.
+                noise_settings.frequency *= 1.1f;
+                noise.applySettings(noise_settings);
+                world.cache().clear();
+                break;
+        }
+        world.rebuildAll(latencies, built);
+    }
+    const f64 total = millisecondsSince(start);
+
+    mesh = original;
+    noise.applySettings(options.noise);
+    return summarize("settings_storm", "chunk", built, total, std::move(latencies), rss_before);
+}
+
+void writeJson(std::ostream& out, const BenchOptions& options, const std::vector<ScenarioResult>& results)
+{
+    out << "{\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"config\": { \"chunk_size\": " << options.chunkSize
+        << ", \"view_radius\": " << options.viewRadius
+        << ", \"lod_distances\": [" << options.streaming.lodLevel0Distance << ", " << options.streaming.lodLevel1Distance
+        << ", " << options.streaming.lodLevel2Distance << "]"
+        << ", \"seed\": " << options.noise.seed << " },\n";
+    out << "  \"scenarios\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const ScenarioResult& r = results[i];
+        out << "    { \"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\""
+            << ", \"items\": " << r.items
+            << ", \"seconds\": " << r.seconds
+            << ", \"throughput\": " << r.throughput
+            << ", \"latency_ms\": { \"p50\": " << r.p50 << ", \"p90\": " << r.p90 << ", \"p99\": " << r.p99 << ", \"max\": " << r.max << " }"
+            << ", \"rss_delta_kb\": " << r.rssDeltaKb
+            << ", \"scratch_peak_bytes\": " << r.scratchPeakBytes << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// Reads back files written by writeJson; not a general JSON parser.
+[[nodiscard]] bool readBaseline(const std::string& path, std::vector<ScenarioResult>& out)
+{
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+
+    auto number = [&](size_t from, size_t until, const char *key, f64& value) {
+        const std::string quoted = std::string("\"") + key + "\":";
+        const size_t at = text.find(quoted, from);
+        if (at == std::string::npos || at >= until) return false;
+        value = std::strtod(text.c_str() + at + quoted.size(), nullptr);
+        return true;
+    };
+
+    size_t pos = 0;
+    while ((pos = text.find("\"name\": \"", pos)) != std::string::npos) {
+        const size_t name_begin = pos + 9;
+        const size_t name_end = text.find('"', name_begin);
+        if (name_end == std::string::npos) return false;
+
+        size_t next = text.find("\"name\": \"", name_end);
+        if (next == std::string::npos) next = text.size();
+
+        ScenarioResult r;
+        r.name = text.substr(name_begin, name_end - name_begin);
+        if (!number(name_end, next, "throughput", r.throughput) || !number(name_end, next, "p99", r.p99)) return false;
+        number(name_end, next, "p50", r.p50);
+        out.push_back(r);
+        pos = next;
+    }
+    return !out.empty();
+}
+
+// Prints a comparison table to stderr; returns the number of regressed scenarios.
+u32 compareWithBaseline(const std::vector<ScenarioResult>& baseline, const std::vector<ScenarioResult>& results, f64 tolerance)
+{
+    u32 regressions = 0;
+    std::fprintf(stderr, "%-20s %14s %14s %8s %10s %10s %8s\n", "scenario", "base chunks/s", "chunks/s", "delta", "base p99", "p99", "delta");
+
+    for (const ScenarioResult& r : results) {
+        auto it = std::find_if(baseline.begin(), baseline.end(), [&](const ScenarioResult& b) { return b.name == r.name; });
+        if (it == baseline.end()) {
+            std::fprintf(stderr, "%-20s %14s\n", r.name.c_str(), "(new)");
+            continue;
+        }
+
+        const f64 throughput_delta = it->throughput > 0.0 ? r.throughput / it->throughput - 1.0 : 0.0;
+        const f64 p99_delta = it->p99 > 0.0 ? r.p99 / it->p99 - 1.0 : 0.0;
+        const bool regressed = throughput_delta < -tolerance || p99_delta > tolerance;
+        if (regressed) regressions++;
+
+        std::fprintf(stderr, "%-20s %14.1f %14.1f %+7.1f%% %10.3f %10.3f %+7.1f%%%s\n",
+                     r.name.c_str(), it->throughput, r.throughput, throughput_delta * 100.0,
+                     it->p99, r.p99, p99_delta * 100.0, regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+#ifndef TERRAIN_TRACE
+    if (!options.trace.empty()) {
+        std::fprintf(stderr, "terrain_bench: --trace needs a build with trace=yes\n");
+        return 1;
+    }
+#endif
+
+    std::vector<ScenarioResult> baseline;
+    if (!options.baseline.empty() && !readBaseline(options.baseline, baseline)) {
+        std::fprintf(stderr, "terrain_bench: could not read baseline '%s'\n", options.baseline.c_str());
+        return 1;
+    }
+
+    TRACE_THREAD_NAME("main");
+
+    NoiseGenerator noise;
+    noise.applySettings(options.noise);
+    BenchWorld world(options, noise);
+
+    std::vector<ScenarioResult> results;
+    for (const TerrainLevelOfDetail lod : { TerrainLevelOfDetail::LEVEL_0, TerrainLevelOfDetail::LEVEL_1,
+                                            TerrainLevelOfDetail::LEVEL_2, TerrainLevelOfDetail::LEVEL_3 }) {
+        results.push_back(runSingleChunk(world, options, lod));
+    }
+    for (const u16 chunk_size : { u16(16), u16(32), u16(64), u16(128) }) {
+        for (i32 lod = 0; lod < 4; lod++) {
+            results.push_back(runMeshKernel(options, noise, chunk_size, static_cast<TerrainLevelOfDetail>(lod)));
+        }
+    }
+    results.push_back(runViewFill(world));
+    results.push_back(runFlythrough(world, options));
+    results.push_back(runSettingsStorm(world, options, noise));
+
+    if (options.out.empty()) {
+        writeJson(std::cout, options, results);
+    } else {
+        std::ofstream file(options.out, std::ios::trunc);
+        writeJson(file, options, results);
+        if (!file) {
+            std::fprintf(stderr, "terrain_bench: could not write '%s'\n", options.out.c_str());
+            return 1;
+        }
+    }
+
+#ifdef TERRAIN_TRACE
+    if (!options.trace.empty() && !traceWrite(options.trace)) {
+        std::fprintf(stderr, "terrain_bench: could not write trace '%s'\n", options.trace.c_str());
+    }
+#endif
+
+    if (!baseline.empty() && compareWithBaseline(baseline, results, options.tolerance) > 0) {
+        return 2;
+    }
+    return 0;
+}